@@ -3,6 +3,8 @@
 #define _GNU_SOURCE
 #include "ArkStudio.h"
 #include "config.h"
+#include "logic.h"
+#include "evl.h"
 
 #include <stdio.h>
 #include <stdlib.h>
@@ -14,17 +16,19 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/types.h>
 #include <stdint.h>
 #include <ctype.h>
 #include <time.h>
+#include <stdatomic.h>
 
 /* -------------------- Paramètres serveur -------------------- */
 
 static volatile int server_running = 0;
 static volatile int reload_flag = 0;
 static pthread_t server_thread;
+static evl_t http_loop;          // réacteur du thread HTTP (sockets d'écoute)
 static uint16_t server_port = 8080; // surchargé par conf_start(port)
 
 /* Écoute en parallèle sur les deux interfaces de BBB1 */
@@ -47,6 +51,7 @@ typedef struct {
 static conf_log_t mlogs[CONF_LOG_RING_SZ];
 static int mlog_head=0, mlog_tail=0, mlog_count=0;
 static pthread_mutex_t mlog_mtx = PTHREAD_MUTEX_INITIALIZER;
+static _Atomic uint64_t mlog_version = 1; // incrémenté à chaque ajout (cache de GET /logs)
 
 static void fmt_now(char out[32]) {
     time_t now = time(NULL);
@@ -67,6 +72,7 @@ static void _conf_log_nolock(const char* action, const char* detail) {
     mlogs[idx].detail[sizeof(mlogs[idx].detail)-1] = '\0';
     mlog_tail = (mlog_tail+1) % CONF_LOG_RING_SZ;
     mlog_count++;
+    atomic_fetch_add(&mlog_version, 1);
 }
 
 /* API publique */
@@ -76,8 +82,10 @@ void conf_add_log(const char* action, const char* detail) {
     pthread_mutex_unlock(&mlog_mtx);
 }
 
-static void build_logs_json(char* out, size_t sz) {
+/* Retourne la version du journal rendue (lue sous le verrou) */
+static uint64_t build_logs_json(char* out, size_t sz) {
     pthread_mutex_lock(&mlog_mtx);
+    uint64_t version = atomic_load(&mlog_version);
     int i=0, idx=mlog_head;
     size_t off=0; off += snprintf(out+off, sz-off, "[\n");
     for (; i<mlog_count; ++i) {
@@ -90,39 +98,115 @@ static void build_logs_json(char* out, size_t sz) {
     }
     snprintf(out+off, sz-off, "]\n");
     pthread_mutex_unlock(&mlog_mtx);
+    return version;
+}
+
+/* -------------------- Endpoints JSON enregistrés -------------------- */
+
+#define CONF_MAX_ENDPOINTS 8
+typedef struct {
+    char path[32];
+    conf_json_fn fn;
+} conf_endpoint_t;
+static conf_endpoint_t endpoints[CONF_MAX_ENDPOINTS];
+static int n_endpoints = 0;
+
+int conf_add_endpoint(const char *path, conf_json_fn fn) {
+    if (!path || !fn || n_endpoints >= CONF_MAX_ENDPOINTS || strlen(path) >= sizeof(endpoints[0].path)) return -1;
+    strcpy(endpoints[n_endpoints].path, path);
+    endpoints[n_endpoints].fn = fn;
+    n_endpoints++;
+    return 0;
+}
+
+/* -------------------- Connexions (pool fixe) -------------------- */
+
+/* Serveur non bloquant: chaque connexion a ses tampons dans un pool statique.
+ * Les requêtes sont découpées au fil des octets reçus (en-têtes puis
+ * Content-Length), traitées dans l'ordre (pipelining), une réponse en
+ * attente d'envoi au plus par connexion; HTTP/1.1 keep-alive par défaut. */
+#define CONF_MAX_CONN  16          // connexions simultanées (au-delà: 503)
+#define CONF_IDLE_MS   10000       // fermeture d'une connexion inactive
+#define CONF_OUT_SZ    (16384)     // une réponse (en-têtes + corps)
+
+typedef struct {
+    int      fd;                   // -1 = libre
+    size_t   in_len;               // octets reçus non consommés
+    size_t   out_len, out_off;     // réponse en attente / déjà envoyée
+    uint32_t events;               // événements epoll attendus
+    int      keep_alive;           // requête courante: connexion conservée
+    int      closing;              // fermer après l'envoi de la réponse
+    int      peer_closed;          // fin de flux reçue du client
+    int64_t  last_ns;              // dernière activité (CLOCK_MONOTONIC)
+    char     in[MAX_REQ];
+    char     out[CONF_OUT_SZ];
+} http_conn_t;
+
+static http_conn_t conns[CONF_MAX_CONN];
+static int http_tfd = -1;          // timer des connexions inactives
+static int http_idle_armed = 0;
+
+static int64_t http_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
 /* -------------------- Helpers HTTP -------------------- */
 
-static void send_http_response(int fd, int code, const char *ctype, const char *body) {
-    char header[256];
-    int body_len = (int)(body ? strlen(body) : 0);
-    snprintf(header, sizeof(header),
+/* Réponse complète dans c->out; etag non NULL: en-têtes ETag + revalidation */
+static void http_put(http_conn_t *c, int code, const char *ctype, const char *etag,
+                     const char *body, size_t body_len) {
+    size_t room = sizeof(c->out) - c->out_len;
+    char cache_hdr[96] = "";
+    if (etag) snprintf(cache_hdr, sizeof(cache_hdr), "ETag: %s\r\nCache-Control: no-cache\r\n", etag);
+    int n = snprintf(c->out + c->out_len, room,
              "HTTP/1.1 %d %s\r\n"
              "Content-Type: %s; charset=UTF-8\r\n"
-             "Content-Length: %d\r\n"
-             "Connection: close\r\n"
+             "Content-Length: %zu\r\n"
+             "%s"
+             "Connection: %s\r\n"
              "\r\n",
              code,
              (code == 200 ? "OK" :
               (code == 201 ? "Created" :
                (code == 302 ? "Found" :
                 (code == 400 ? "Bad Request" :
-                 (code == 404 ? "Not Found" : "Error"))))),
+                 (code == 404 ? "Not Found" :
+                  (code == 501 ? "Not Implemented" : "Error")))))),
              ctype ? ctype : "text/plain",
-             body_len);
-    send(fd, header, strlen(header), 0);
-    if (body && body_len > 0) send(fd, body, body_len, 0);
+             body_len, cache_hdr, c->keep_alive ? "keep-alive" : "close");
+    if (n < 0 || (size_t)n + (size_t)body_len > room) { // ne devrait pas arriver: corps < CONF_OUT_SZ
+        c->keep_alive = 0;
+        n = snprintf(c->out + c->out_len, room,
+                     "HTTP/1.1 500 Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+        c->out_len += (size_t)n;
+        return;
+    }
+    if (body_len) memcpy(c->out + c->out_len + (size_t)n, body, body_len);
+    c->out_len += (size_t)n + body_len;
+}
+
+static void send_http_response(http_conn_t *c, int code, const char *ctype, const char *body) {
+    http_put(c, code, ctype, NULL, body, body ? strlen(body) : 0);
+}
+
+static void send_http_not_modified(http_conn_t *c, const char *etag) {
+    int n = snprintf(c->out + c->out_len, sizeof(c->out) - c->out_len,
+             "HTTP/1.1 304 Not Modified\r\n"
+             "ETag: %s\r\n"
+             "Cache-Control: no-cache\r\n"
+             "Connection: %s\r\n\r\n", etag, c->keep_alive ? "keep-alive" : "close");
+    if (n > 0 && (size_t)n < sizeof(c->out) - c->out_len) c->out_len += (size_t)n;
 }
 
-static void send_http_redirect(int fd, const char *location) {
-    char header[512];
-    snprintf(header, sizeof(header),
+static void send_http_redirect(http_conn_t *c, const char *location) {
+    int n = snprintf(c->out + c->out_len, sizeof(c->out) - c->out_len,
              "HTTP/1.1 302 Found\r\n"
              "Location: %s\r\n"
              "Content-Length: 0\r\n"
-             "Connection: close\r\n\r\n", location);
-    send(fd, header, strlen(header), 0);
+             "Connection: %s\r\n\r\n", location, c->keep_alive ? "keep-alive" : "close");
+    if (n > 0 && (size_t)n < sizeof(c->out) - c->out_len) c->out_len += (size_t)n;
 }
 
 static int write_atomic_json(const char *path, const char *json, size_t len) {
@@ -151,8 +235,111 @@ static int write_atomic_json(const char *path, const char *json, size_t len) {
 }
 
 
-static void build_current_config_json(char *buf, size_t sz) {
-    snprintf(buf, sz,
+/* Clés hors formulaire: toujours écrites avec leur valeur courante pour
+ * qu'un POST /apply ne les perde pas dans config.json. */
+static int build_extra_config_json(char *buf, size_t sz) {
+    int n = snprintf(buf, sz,
+        "  \"sample_rate_hz\": %d,\n"
+        "  \"nominal_freq_hz\": %.3f,\n"
+        "  \"harm_cycles\": %d,\n"
+        "  \"curve_A\": \"%s\",\n"
+        "  \"time_dial_A\": %.3f,\n"
+        "  \"curve_V\": \"%s\",\n"
+        "  \"time_dial_V\": %.3f,\n"
+        "  \"ioc_pickup_A\": %.3f,\n"
+        "  \"ioc_delay_ms\": %d,\n"
+        "  \"fast_pickup_A\": %.3f,\n"
+        "  \"fast_count\": %d,\n"
+        "  \"uv_pickup_V\": %.3f,\n"
+        "  \"uv_delay_ms\": %d,\n"
+        "  \"filter_window\": %d,\n"
+        "  \"outlier_tol\": %.3f,\n"
+        "  \"max_loss_ratio\": %.3f,\n"
+        "  \"rt_policy\": \"%s\",\n"
+        "  \"rt_priority\": %d,\n"
+        "  \"rt_cpu\": %d,\n"
+        "  \"nrt_policy\": \"%s\",\n"
+        "  \"nrt_priority\": %d,\n"
+        "  \"nrt_cpu\": %d,\n"
+        "  \"acq_policy\": \"%s\",\n"
+        "  \"acq_priority\": %d,\n"
+        "  \"acq_cpu\": %d,\n"
+        "  \"backend\": \"%s\",\n"
+        "  \"replay_file\": \"%s\",\n"
+        "  \"replay_loop\": %d,\n"
+        "  \"capture_file\": \"%s\",\n"
+        "  \"synth_freq_hz\": %.3f,\n"
+        "  \"synth_current_A\": %.3f,\n"
+        "  \"synth_voltage_V\": %.3f,\n"
+        "  \"synth_harm_pct\": \"%s\",\n"
+        "  \"synth_noise_pct\": %.3f,\n"
+        "  \"synth_fault_at_ms\": %d,\n"
+        "  \"synth_fault_gain\": %.3f,\n"
+        "  \"synth_fault_ch\": %d,\n"
+        "  \"channels\": %d,\n"
+        "  \"trig_lines\": \"%s\",\n"
+        "  \"echo_lines\": \"%s\",\n"
+        "  \"calib_A\": \"%s\",\n"
+        "  \"calib_V\": \"%s\"",
+        config_get_sample_rate_hz(),
+        config_get_nominal_freq_hz(),
+        config_get_harm_cycles(),
+        config_get_curve_A(),
+        config_get_time_dial_A(),
+        config_get_curve_V(),
+        config_get_time_dial_V(),
+        config_get_ioc_pickup_A(),
+        config_get_ioc_delay_ms(),
+        config_get_fast_pickup_A(),
+        config_get_fast_count(),
+        config_get_uv_pickup_V(),
+        config_get_uv_delay_ms(),
+        config_get_filter_window(),
+        config_get_outlier_tol(),
+        config_get_max_loss_ratio(),
+        config_get_rt_policy(),
+        config_get_rt_priority(),
+        config_get_rt_cpu(),
+        config_get_nrt_policy(),
+        config_get_nrt_priority(),
+        config_get_nrt_cpu(),
+        config_get_acq_policy(),
+        config_get_acq_priority(),
+        config_get_acq_cpu(),
+        config_get_backend(),
+        config_get_replay_file(),
+        config_get_replay_loop(),
+        config_get_capture_file(),
+        config_get_synth_freq_hz(),
+        config_get_synth_current_A(),
+        config_get_synth_voltage_V(),
+        config_get_synth_harm_pct(),
+        config_get_synth_noise_pct(),
+        config_get_synth_fault_at_ms(),
+        config_get_synth_fault_gain(),
+        config_get_synth_fault_ch(),
+        config_get_channels(),
+        config_get_trig_lines(),
+        config_get_echo_lines(),
+        config_get_calib_A(-1),
+        config_get_calib_V(-1)
+    );
+    /* Tables par voie: seulement celles qui surchargent la table commune */
+    for (int c = 0; c < CONFIG_MAX_CHANNELS && n > 0 && (size_t)n < sz; ++c) {
+        if (config_get_calib_A(c)[0])
+            n += snprintf(buf + n, sz - (size_t)n, ",\n  \"calib_A_%d\": \"%s\"", c, config_get_calib_A(c));
+        if ((size_t)n < sz && config_get_calib_V(c)[0])
+            n += snprintf(buf + n, sz - (size_t)n, ",\n  \"calib_V_%d\": \"%s\"", c, config_get_calib_V(c));
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "\n");
+    return n;
+}
+
+/* JSON complet: champs du formulaire + clés étendues. Retourne la longueur ou -1. */
+static int build_config_json(char *buf, size_t sz,
+                             double thrA, int tmsA, double thrV, int tmsV,
+                             int smp, int slp, const char *logic) {
+    int n = snprintf(buf, sz,
         "{\n"
         "  \"threshold_A\": %.3f,\n"
         "  \"tms_A_ms\": %d,\n"
@@ -160,8 +347,19 @@ static void build_current_config_json(char *buf, size_t sz) {
         "  \"tms_V_ms\": %d,\n"
         "  \"samples\": %d,\n"
         "  \"sleep_between_samples_ms\": %d,\n"
-        "  \"trip_logic\": \"%s\"\n"
-        "}\n",
+        "  \"trip_logic\": \"%s\",\n",
+        thrA, tmsA, thrV, tmsV, smp, slp, logic);
+    if (n <= 0 || (size_t)n >= sz) return -1;
+    int m = build_extra_config_json(buf + n, sz - (size_t)n);
+    if (m <= 0 || (size_t)(n + m) >= sz) return -1;
+    n += m;
+    int e = snprintf(buf + n, sz - (size_t)n, "}\n");
+    if (e <= 0 || (size_t)(n + e) >= sz) return -1;
+    return n + e;
+}
+
+static void build_current_config_json(char *buf, size_t sz) {
+    build_config_json(buf, sz,
         config_get_threshold_A(),
         config_get_tms_A_ms(),
         config_get_threshold_V(),
@@ -189,7 +387,7 @@ static void render_home_html(char *out, size_t sz, const char *msg) {
     int    tmsV = config_get_tms_V_ms();
     int    smp  = config_get_samples();
     int    slp  = config_get_sleep_ms();
-    const char *logic = config_get_trip_logic(); // "any" ou "both"
+    const char *logic = config_get_trip_logic(); // "any", "both" ou expression
 
     snprintf(out, sz,
         "<!DOCTYPE html><html lang=\"fr\"><head><meta charset=\"utf-8\"/>"
@@ -216,15 +414,15 @@ static void render_home_html(char *out, size_t sz, const char *msg) {
         "<input name=\"tms_V_ms\" type=\"number\" min=\"1\" max=\"600000\" value=\"%d\" required>"
 
         "<label>samples</label>"
-        "<input name=\"samples\" type=\"number\" min=\"1\" max=\"128\" value=\"%d\" required>"
+        "<input name=\"samples\" type=\"number\" min=\"1\" max=\"100000\" value=\"%d\" required>"
         "<label>sleep_between_samples_ms</label>"
         "<input name=\"sleep_between_samples_ms\" type=\"number\" min=\"0\" max=\"1000\" value=\"%d\" required>"
 
         "<label>trip_logic</label>"
-        "<select name=\"trip_logic\">"
-        "<option value=\"any\" %s>any</option>"
-        "<option value=\"both\" %s>both</option>"
-        "</select>"
+        "<input name=\"trip_logic\" list=\"trip_logic_list\" maxlength=\"127\" value=\"%s\" required>"
+        "<datalist id=\"trip_logic_list\"><option value=\"any\"><option value=\"both\"></datalist>"
+        "<p><small>any | both | expression: <code>50 51 27 59 A V</code>, <code>! &amp; |</code>, "
+        "<code>2of(51 59 27)</code>, <code>tpu(ms x)</code>, <code>tdo(ms x)</code></small></p>"
 
         "<button type=\"submit\">Appliquer</button>"
         "</form>"
@@ -234,11 +432,67 @@ static void render_home_html(char *out, size_t sz, const char *msg) {
         "</body></html>",
         (msg && *msg) ? msg : "",
         thrA, tmsA, thrV, tmsV, smp, slp,
-        (logic && strcmp(logic,"any")==0) ? "selected" : "",
-        (logic && strcmp(logic,"both")==0) ? "selected" : ""
+        logic ? logic : DEFAULT_TRIP_LOGIC
     );
 }
 
+/* -------------------- Réponses pré-rendues (ETag) -------------------- */
+
+/* Corps de GET /, /config et /logs rendus une fois par version (génération
+ * de config_load, compteur du journal) puis resservis tels quels. ETag =
+ * "<démarrage>-<version>": If-None-Match identique -> 304 sans corps.
+ * Accès depuis le thread HTTP uniquement. */
+#define CONF_CACHE_SZ (8192)
+
+enum { CONF_CACHE_HOME, CONF_CACHE_CONFIG, CONF_CACHE_LOGS, CONF_CACHE_COUNT };
+
+typedef struct {
+    uint64_t version;              // 0 = jamais rendu
+    size_t   len;
+    char     etag[40];
+    char     body[CONF_CACHE_SZ];
+} http_cache_t;
+
+static http_cache_t http_cache[CONF_CACHE_COUNT];
+static uint64_t http_boot_id;      // ETag distincts d'un démarrage à l'autre
+
+static const http_cache_t* http_cache_get(int which) {
+    http_cache_t *e = &http_cache[which];
+    uint64_t v = (which == CONF_CACHE_LOGS) ? atomic_load(&mlog_version)
+                                            : (uint64_t)config_generation();
+    if (e->version == v) return e;
+
+    /* version lue avant le rendu: un rechargement concurrent invalide au prochain appel */
+    switch (which) {
+    case CONF_CACHE_HOME:   render_home_html(e->body, sizeof(e->body), ""); break;
+    case CONF_CACHE_CONFIG: build_current_config_json(e->body, sizeof(e->body)); break;
+    default:                v = build_logs_json(e->body, sizeof(e->body)); break;
+    }
+    e->len = strlen(e->body);
+    e->version = v;
+    snprintf(e->etag, sizeof(e->etag), "\"%llx-%llx\"",
+             (unsigned long long)http_boot_id, (unsigned long long)v);
+    return e;
+}
+
+/* If-None-Match: "*" ou liste contenant l'ETag courant */
+static int http_etag_match(const char *hdrs, const char *etag) {
+    const char *inm = strcasestr(hdrs, "\r\nIf-None-Match:");
+    if (!inm) return 0;
+    inm += 16;
+    const char *eol = strstr(inm, "\r\n");
+    size_t len = eol ? (size_t)(eol - inm) : strlen(inm);
+    char val[256];
+    snprintf(val, sizeof(val), "%.*s", (int)(len < sizeof(val) ? len : sizeof(val) - 1), inm);
+    return strchr(val, '*') != NULL || strstr(val, etag) != NULL;
+}
+
+static void send_http_cached(http_conn_t *c, const char *req, int which, const char *ctype) {
+    const http_cache_t *e = http_cache_get(which);
+    if (http_etag_match(req, e->etag)) { send_http_not_modified(c, e->etag); return; }
+    http_put(c, 200, ctype, e->etag, e->body, e->len);
+}
+
 /* -------------------- Form-urlencoded parsing -------------------- */
 
 static int hexval(char c){ if(c>='0'&&c<='9')return c-'0'; if(c>='a'&&c<='f')return c-'a'+10; if(c>='A'&&c<='F')return c-'A'+10; return -1;}
@@ -270,85 +524,44 @@ static int kv_get(const char *body, const char *key, char *out, size_t outsz) {
 
 /* -------------------- Thread HTTP (multi-interfaces) -------------------- */
 
-static void* http_thread(void *arg) {
-    (void)arg;
+/* Requête complète de r octets (en-têtes + corps de content_length octets,
+ * terminée par '\0') -> réponse dans c->out */
+static void http_dispatch(http_conn_t *c, char *req, size_t r, int content_length) {
+    char method[8]={0}; char path[64]={0};
+    sscanf(req,"%7s %63s", method, path);
 
-    int socks[2] = {-1, -1};
-    const char* ifaces[2] = { CONF_IFACE_ETH0, CONF_IFACE_USB0 };
+    char *hdr_end=strstr(req,"\r\n\r\n");
+    char *body = hdr_end ? (hdr_end+4) : NULL;
 
-    for (int i = 0; i < 2; ++i) {
-        socks[i] = socket(AF_INET, SOCK_STREAM, 0);
-        if (socks[i] < 0) { fprintf(stderr, "[ERROR] socket(%s): %s\n", ifaces[i], strerror(errno)); continue; }
-        int opt = 1; setsockopt(socks[i], SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
-        struct sockaddr_in a; memset(&a,0,sizeof(a));
-        a.sin_family = AF_INET; a.sin_port = htons(server_port); a.sin_addr.s_addr = inet_addr(ifaces[i]);
-        if (bind(socks[i], (struct sockaddr*)&a, sizeof(a)) != 0) { fprintf(stderr,"[ERROR] bind %s:%u: %s\n", ifaces[i], server_port, strerror(errno)); close(socks[i]); socks[i]=-1; continue; }
-        if (listen(socks[i], 8) != 0) { fprintf(stderr,"[ERROR] listen(%s): %s\n", ifaces[i], strerror(errno)); close(socks[i]); socks[i]=-1; continue; }
-        char info[96]; snprintf(info,sizeof(info),"HTTP listening on %s:%u", ifaces[i], server_port);
-        _conf_log_nolock("INFO", info); /* pas besoin de mutex ici avant la boucle */
-        fprintf(stdout, "[INFO] %s\n", info);
+    /* GET / -> IHM HTML (pré-rendue) */
+    if (strcmp(method,"GET")==0 && strcmp(path,"/")==0){
+        send_http_cached(c, req, CONF_CACHE_HOME, "text/html");
+        return;
     }
-    if (socks[0] < 0 && socks[1] < 0) { fprintf(stderr, "[ERROR] Aucun socket HTTP démarré.\n"); server_running=0; return NULL; }
-
-    while (server_running) {
-        fd_set rfds; FD_ZERO(&rfds); int maxfd=-1;
-        for (int i=0;i<2;++i) if (socks[i]>=0){ FD_SET(socks[i], &rfds); if (socks[i]>maxfd) maxfd=socks[i]; }
-        struct timeval tv={.tv_sec=1,.tv_usec=0};
-        int sel=select(maxfd+1,&rfds,NULL,NULL,&tv);
-        if (sel<0){ if(errno==EINTR) continue; fprintf(stderr,"[WARN] select: %s\n",strerror(errno)); continue; }
-        if (sel==0) continue;
-
-        int fd=-1; struct sockaddr_in cli; socklen_t clilen=sizeof(cli);
-        for (int i=0;i<2;++i){
-            if (socks[i]>=0 && FD_ISSET(socks[i],&rfds)){
-                fd=accept(socks[i],(struct sockaddr*)&cli,&clilen);
-                if (fd<0){ if(errno==EINTR) continue; if(!server_running) break; fprintf(stderr,"[WARN] accept(%d): %s\n",i,strerror(errno)); continue; }
-                break;
-            }
-        }
-        if (fd<0) continue;
-
-        char req[MAX_REQ];
-        ssize_t r=recv(fd, req, sizeof(req)-1, 0);
-        if (r<=0){ close(fd); continue; }
-        req[r]='\0';
-
-        char method[8]={0}; char path[64]={0};
-        sscanf(req,"%7s %63s", method, path);
-
-        int content_length=0;
-        char *cl=strcasestr(req,"Content-Length:");
-        if (cl) sscanf(cl,"Content-Length: %d",&content_length);
 
-        char *hdr_end=strstr(req,"\r\n\r\n");
-        char *body = hdr_end ? (hdr_end+4) : NULL;
-
-        /* GET / -> IHM HTML */
-        if (strcmp(method,"GET")==0 && strcmp(path,"/")==0){
-            char page[4096];
-            render_home_html(page,sizeof(page), "");
-            send_http_response(fd, 200, "text/html", page);
-            close(fd);
-            continue;
-        }
+    /* GET /config -> JSON (pré-rendu) */
+    if (strcmp(method,"GET")==0 && strcmp(path,"/config")==0){
+        send_http_cached(c, req, CONF_CACHE_CONFIG, "application/json");
+        return;
+    }
 
-        /* GET /config -> JSON */
-        if (strcmp(method,"GET")==0 && strcmp(path,"/config")==0){
-            char json[256];
-            build_current_config_json(json, sizeof(json));
-            send_http_response(fd, 200, "application/json", json);
-            close(fd);
-            continue;
-        }
+    /* GET /logs -> JSON (pré-rendu) */
+    if (strcmp(method,"GET")==0 && strcmp(path,"/logs")==0){
+        send_http_cached(c, req, CONF_CACHE_LOGS, "application/json");
+        return;
+    }
 
-        /* GET /logs -> JSON */
-        if (strcmp(method,"GET")==0 && strcmp(path,"/logs")==0){
+    /* GET <endpoint enregistré> -> JSON (ex. /latency) */
+    if (strcmp(method,"GET")==0){
+        int e = 0;
+        while (e < n_endpoints && strcmp(path, endpoints[e].path) != 0) e++;
+        if (e < n_endpoints) {
             char js[8192];
-            build_logs_json(js,sizeof(js));
-            send_http_response(fd, 200, "application/json", js);
-            close(fd);
-            continue;
+            endpoints[e].fn(js, sizeof(js));
+            send_http_response(c, 200, "application/json", js);
+            return;
         }
+    }
 
 
 
@@ -356,9 +569,8 @@ static void* http_thread(void *arg) {
 if (strcmp(method,"POST")==0 && strcmp(path,"/apply")==0) {
     if (content_length <= 0 || content_length > MAX_CFG_BODY) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Payload invalide.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
 
     size_t have=0; char bufp[MAX_CFG_BODY+1];
@@ -367,22 +579,16 @@ if (strcmp(method,"POST")==0 && strcmp(path,"/apply")==0) {
         if (in_first > (size_t)content_length) in_first=(size_t)content_length;
         memcpy(bufp, body, in_first); have=in_first;
     }
-    while (have < (size_t)content_length) {
-        ssize_t rr=recv(fd, bufp+have, (size_t)content_length-have, 0);
-        if (rr <= 0) { break; }
-        have += (size_t)rr;
-    }
     if (have != (size_t)content_length) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Body incomplet.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
     bufp[content_length]='\0';
 
     /* parse des champs étendus */
     char s_thrA[64]={0}, s_tmsA[32]={0}, s_thrV[64]={0}, s_tmsV[32]={0};
-    char s_smp[32]={0}, s_slp[32]={0}, s_logic[16]={0};
+    char s_smp[32]={0}, s_slp[32]={0}, s_logic[TRIP_LOGIC_MAX]={0};
 
     int ok = 1;
     ok &= kv_get(bufp,"threshold_A", s_thrA,sizeof(s_thrA));
@@ -395,9 +601,8 @@ if (strcmp(method,"POST")==0 && strcmp(path,"/apply")==0) {
 
     if (!ok) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Champs manquants.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
 
     /* validations rapides */
@@ -409,91 +614,308 @@ if (strcmp(method,"POST")==0 && strcmp(path,"/apply")==0) {
     int    slp  = atoi(s_slp);
     urldecode(s_logic); // pour sûreté
 
-    int logic_ok = (strcmp(s_logic,"any")==0 || strcmp(s_logic,"both")==0);
+    logic_prog_t prog;
+    int logic_ok = (logic_compile(&prog, s_logic, NULL, 0) == 0);
 
     if (!(thrA >= 0.0 && thrV >= 0.0 &&
           tmsA > 0 && tmsV > 0 &&
-          smp >= 1 && smp <= 128 &&
+          smp >= 1 && smp <= MAX_SAMPLES &&
           slp >= 0 && slp <= 1000 &&
           logic_ok)) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Valeurs invalides.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
 
-    /* fabrique le JSON étendu exact */
-    char json[256];
-    int n = snprintf(json,sizeof(json),
-        "{\n"
-        "  \"threshold_A\": %.3f,\n"
-        "  \"tms_A_ms\": %d,\n"
-        "  \"threshold_V\": %.3f,\n"
-        "  \"tms_V_ms\": %d,\n"
-        "  \"samples\": %d,\n"
-        "  \"sleep_between_samples_ms\": %d,\n"
-        "  \"trip_logic\": \"%s\"\n"
-        "}\n",
-        thrA, tmsA, thrV, tmsV, smp, slp, s_logic
-    );
+    /* fabrique le JSON étendu exact (les clés hors formulaire gardent leur valeur courante) */
+    char json[8192];
+    int n = build_config_json(json, sizeof(json), thrA, tmsA, thrV, tmsV, smp, slp, s_logic);
     if (n <= 0 || n >= (int)sizeof(json)) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Construction JSON impossible.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
 
     if (write_atomic_json("config.json", json, (size_t)n) != 0) {
         char page[4096]; render_home_html(page,sizeof(page), "<p class='err'>Écriture fichier échouée.</p>");
-        send_http_response(fd, 400, "text/html", page);
-        close(fd);
-        continue;
+        send_http_response(c, 400, "text/html", page);
+        return;
     }
 
     reload_flag = 1;
-    char info[160];
+    char info[320];
     snprintf(info,sizeof(info),
              "CONFIG_APPLY_EXT thrA=%.3f tmsA=%d thrV=%.3f tmsV=%d smp=%d slp=%d logic=%s",
              thrA, tmsA, thrV, tmsV, smp, slp, s_logic);
     conf_add_log("CONFIG_APPLY_EXT", info);
 
     /* redirection vers l'accueil */
-    send_http_redirect(fd, "/");
-    close(fd);
-    continue;
+    send_http_redirect(c, "/");
+    return;
 }
 
 
-        /* POST /config -> JSON (API existante) */
-        if (strcmp(method,"POST")==0 && strcmp(path,"/config")==0){
-            if (content_length <= 0 || content_length > MAX_CFG_BODY) { send_http_response(fd,400,"text/plain","Missing/Too large JSON body\n"); close(fd); continue; }
-            size_t have=0; char bufj[MAX_CFG_BODY+1];
-            if (body){
-                size_t in_first=(size_t)(r - (body - req));
-                if (in_first>(size_t)content_length) in_first=(size_t)content_length;
-                memcpy(bufj, body, in_first); have=in_first;
-            }
-            while (have < (size_t)content_length){
-                ssize_t rr=recv(fd, bufj+have,(size_t)content_length-have,0);
-                if (rr <= 0) { break; }
-                have += (size_t)rr;
+    /* POST /config -> JSON (API existante) */
+    if (strcmp(method,"POST")==0 && strcmp(path,"/config")==0){
+        if (content_length <= 0 || content_length > MAX_CFG_BODY) { send_http_response(c,400,"text/plain","Missing/Too large JSON body\n"); return; }
+        size_t have=0; char bufj[MAX_CFG_BODY+1];
+        if (body){
+            size_t in_first=(size_t)(r - (body - req));
+            if (in_first>(size_t)content_length) in_first=(size_t)content_length;
+            memcpy(bufj, body, in_first); have=in_first;
+        }
+        if (have != (size_t)content_length){ send_http_response(c,400,"text/plain","Incomplete body\n"); return; }
+        bufj[content_length]='\0';
+        if (!is_probably_json(bufj)){ send_http_response(c,400,"text/plain","Invalid JSON\n"); return; }
+        if (write_atomic_json("config.json", bufj, (size_t)content_length) != 0){ send_http_response(c,400,"text/plain","Write failed\n"); return; }
+        reload_flag = 1;
+        conf_add_log("CONFIG_JSON", "config updated via JSON");
+        send_http_response(c, 201, "application/json", "{\"status\":\"updated\"}\n");
+        return;
+    }
+
+    /* 404 par défaut */
+    send_http_response(c, 404, "text/plain", "Not Found\n");
+}
+
+/* -------------------- Boucle d'événements HTTP -------------------- */
+
+static void http_conn_close(http_conn_t *c) {
+    evl_del(&http_loop, c->fd);
+    close(c->fd);
+    c->fd = -1;
+}
+
+static void http_want(http_conn_t *c, uint32_t events) {
+    if (c->events != events && evl_mod(&http_loop, c->fd, events) == 0) c->events = events;
+}
+
+/* Envoie la réponse en attente: 0 si tout est parti, 1 si socket pleine, -1 si erreur */
+static int http_flush(http_conn_t *c) {
+    while (c->out_off < c->out_len) {
+        ssize_t w = send(c->fd, c->out + c->out_off, c->out_len - c->out_off, MSG_NOSIGNAL);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 1 : -1;
+        }
+        c->out_off += (size_t)w;
+    }
+    c->out_len = c->out_off = 0;
+    return 0;
+}
+
+/* Connection: close / keep-alive (défaut selon la version) dans les en-têtes */
+static int http_keep_alive(const char *hdrs) {
+    char version[16] = {0};
+    sscanf(hdrs, "%*s %*s %15s", version);
+    int keep = (strcmp(version, "HTTP/1.1") == 0);
+    const char *conn = strcasestr(hdrs, "\r\nConnection:");
+    if (conn) {
+        conn += 13;
+        const char *eol = strstr(conn, "\r\n");
+        size_t len = eol ? (size_t)(eol - conn) : strlen(conn);
+        char val[32];
+        snprintf(val, sizeof(val), "%.*s", (int)(len < sizeof(val) ? len : sizeof(val) - 1), conn);
+        if (strcasestr(val, "close")) keep = 0;
+        else if (strcasestr(val, "keep-alive")) keep = 1;
+    }
+    return keep;
+}
+
+/* Content-Length des en-têtes (nom insensible à la casse): 0 si absent,
+ * -1 si la valeur n'est pas un entier décimal positif */
+static long http_content_length(const char *hdrs) {
+    const char *cl = strcasestr(hdrs, "\r\nContent-Length:");
+    if (!cl) return 0;
+    cl += 17;
+    while (*cl == ' ' || *cl == '\t') cl++;
+    if (*cl < '0' || *cl > '9') return -1;
+    errno = 0;
+    char *end;
+    long v = strtol(cl, &end, 10);
+    while (*end == ' ' || *end == '\t') end++;
+    if (errno == ERANGE || (*end != '\r' && *end != '\0')) return -1;
+    return v;
+}
+
+/* Traite les requêtes complètes du tampon, dans l'ordre, tant que les réponses partent */
+static void http_process(http_conn_t *c) {
+    for (;;) {
+        int f = http_flush(c);
+        if (f < 0) { http_conn_close(c); return; }
+        if (f > 0) { http_want(c, EPOLLOUT); return; } // reprise sur EPOLLOUT
+        if (c->closing) { http_conn_close(c); return; }
+
+        c->in[c->in_len] = '\0';
+        char *hdr_end = strstr(c->in, "\r\n\r\n");
+        if (!hdr_end) {
+            if (c->in_len >= sizeof(c->in) - 1) { // en-têtes plus grands que le tampon
+                c->keep_alive = 0; c->closing = 1;
+                send_http_response(c, 400, "text/plain", "Request too large\n");
+                continue;
             }
-            if (have != (size_t)content_length){ send_http_response(fd,400,"text/plain","Incomplete body\n"); close(fd); continue; }
-            bufj[content_length]='\0';
-            if (!is_probably_json(bufj)){ send_http_response(fd,400,"text/plain","Invalid JSON\n"); close(fd); continue; }
-            if (write_atomic_json("config.json", bufj, (size_t)content_length) != 0){ send_http_response(fd,400,"text/plain","Write failed\n"); close(fd); continue; }
-            reload_flag = 1;
-            conf_add_log("CONFIG_JSON", "config updated via JSON");
-            send_http_response(fd, 201, "application/json", "{\"status\":\"updated\"}\n");
+            if (c->peer_closed) { http_conn_close(c); return; }
+            http_want(c, EPOLLIN);
+            return;
+        }
+
+        /* En-têtes complets: longueur du corps et persistance */
+        size_t hdr_len = (size_t)(hdr_end + 4 - c->in);
+        *hdr_end = '\0';
+        long content_length = http_content_length(c->in);
+        int chunked = strcasestr(c->in, "\r\nTransfer-Encoding:") != NULL;
+        c->keep_alive = http_keep_alive(c->in);
+        *hdr_end = '\r';
+
+        /* Corps de longueur inconnue: la fin de la requête ne peut être
+         * située, le flux est abandonné (pas de requête suivante mal découpée) */
+        if (chunked || content_length < 0) {
+            c->keep_alive = 0; c->closing = 1;
+            if (chunked) send_http_response(c, 501, "text/plain", "Transfer-Encoding not supported\n");
+            else send_http_response(c, 400, "text/plain", "Invalid Content-Length\n");
+            continue;
+        }
+        size_t need = hdr_len;
+        if (content_length <= MAX_CFG_BODY) {
+            need += (size_t)content_length;
+        } else {
+            c->keep_alive = 0; // corps refusé non lu: flux désynchronisé
+            content_length = -1;
+        }
+        if (need > sizeof(c->in) - 1) {
+            c->keep_alive = 0; c->closing = 1;
+            send_http_response(c, 400, "text/plain", "Request too large\n");
+            continue;
+        }
+        if (c->in_len < need) { // corps incomplet
+            if (c->peer_closed) { http_conn_close(c); return; }
+            http_want(c, EPOLLIN);
+            return;
+        }
+
+        char saved = c->in[need];
+        c->in[need] = '\0';
+        http_dispatch(c, c->in, need, (int)content_length);
+        c->in[need] = saved;
+        memmove(c->in, c->in + need, c->in_len - need);
+        c->in_len -= need;
+        if (!c->keep_alive) c->closing = 1;
+    }
+}
+
+static void http_on_conn(int fd, uint32_t events, void *ctx) {
+    http_conn_t *c = (http_conn_t*)ctx;
+    c->last_ns = http_now_ns();
+    if ((events & (EPOLLERR | EPOLLHUP)) && !(events & EPOLLIN)) { http_conn_close(c); return; }
+    if (events & EPOLLIN) {
+        while (c->in_len < sizeof(c->in) - 1) {
+            ssize_t r = recv(fd, c->in + c->in_len, sizeof(c->in) - 1 - c->in_len, 0);
+            if (r > 0) { c->in_len += (size_t)r; continue; }
+            if (r == 0) { c->peer_closed = 1; break; }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            http_conn_close(c);
+            return;
+        }
+    }
+    http_process(c);
+}
+
+/* Timer (un coup) réarmé sur la plus proche échéance d'inactivité; désarmé sans connexion */
+static void http_idle_rearm(int64_t now) {
+    int64_t next = 0;
+    for (int i = 0; i < CONF_MAX_CONN; ++i) {
+        if (conns[i].fd < 0) continue;
+        int64_t due = conns[i].last_ns + (int64_t)CONF_IDLE_MS * 1000000LL;
+        if (due <= now) { http_conn_close(&conns[i]); continue; }
+        if (next == 0 || due < next) next = due;
+    }
+    http_idle_armed = (next != 0);
+    if (http_idle_armed) evl_timer_arm_abs(http_tfd, next);
+}
+
+static void http_on_idle(int fd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    evl_timer_ack(fd);
+    http_idle_rearm(http_now_ns());
+}
+
+/* Socket d'écoute prête: connexions en attente acceptées (non bloquantes) dans le pool */
+static void http_on_accept(int lfd, uint32_t events, void *ctx) {
+    (void)events; (void)ctx;
+    for (;;) {
+        struct sockaddr_in cli; socklen_t clilen=sizeof(cli);
+        int fd=accept4(lfd,(struct sockaddr*)&cli,&clilen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd<0) {
+            if (errno==EINTR) continue;
+            if (errno!=EAGAIN && errno!=EWOULDBLOCK && errno!=ECONNABORTED)
+                fprintf(stderr,"[WARN] accept(%d): %s\n",lfd,strerror(errno));
+            return;
+        }
+        http_conn_t *c = NULL;
+        for (int i = 0; i < CONF_MAX_CONN && !c; ++i) if (conns[i].fd < 0) c = &conns[i];
+        if (!c) {
+            static const char busy[] = "HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+            ssize_t w = send(fd, busy, sizeof(busy) - 1, MSG_NOSIGNAL); (void)w;
+            close(fd);
+            continue;
+        }
+        c->fd = fd;
+        c->in_len = c->out_len = c->out_off = 0;
+        c->keep_alive = 1; c->closing = 0; c->peer_closed = 0;
+        c->events = EPOLLIN;
+        c->last_ns = http_now_ns();
+        if (evl_add(&http_loop, fd, EPOLLIN, http_on_conn, c) != 0) {
             close(fd);
+            c->fd = -1;
             continue;
         }
+        if (!http_idle_armed && http_tfd >= 0) {
+            evl_timer_arm_abs(http_tfd, c->last_ns + (int64_t)CONF_IDLE_MS * 1000000LL);
+            http_idle_armed = 1;
+        }
+    }
+}
 
-        /* 404 par défaut */
-        send_http_response(fd, 404, "text/plain", "Not Found\n");
-        close(fd);
+static void* http_thread(void *arg) {
+    (void)arg;
+
+    int socks[2] = {-1, -1};
+    const char* ifaces[2] = { CONF_IFACE_ETH0, CONF_IFACE_USB0 };
+
+    for (int i = 0; i < 2; ++i) {
+        socks[i] = socket(AF_INET, SOCK_STREAM, 0);
+        if (socks[i] < 0) { fprintf(stderr, "[ERROR] socket(%s): %s\n", ifaces[i], strerror(errno)); continue; }
+        int opt = 1; setsockopt(socks[i], SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+        struct sockaddr_in a; memset(&a,0,sizeof(a));
+        a.sin_family = AF_INET; a.sin_port = htons(server_port); a.sin_addr.s_addr = inet_addr(ifaces[i]);
+        if (bind(socks[i], (struct sockaddr*)&a, sizeof(a)) != 0) { fprintf(stderr,"[ERROR] bind %s:%u: %s\n", ifaces[i], server_port, strerror(errno)); close(socks[i]); socks[i]=-1; continue; }
+        if (listen(socks[i], 32) != 0) { fprintf(stderr,"[ERROR] listen(%s): %s\n", ifaces[i], strerror(errno)); close(socks[i]); socks[i]=-1; continue; }
+        char info[96]; snprintf(info,sizeof(info),"HTTP listening on %s:%u", ifaces[i], server_port);
+        _conf_log_nolock("INFO", info); /* pas besoin de mutex ici avant la boucle */
+        fprintf(stdout, "[INFO] %s\n", info);
     }
+    if (socks[0] < 0 && socks[1] < 0) { fprintf(stderr, "[ERROR] Aucun socket HTTP démarré.\n"); server_running=0; return NULL; }
 
+    for (int i = 0; i < CONF_MAX_CONN; ++i) conns[i].fd = -1;
+    http_tfd = evl_timer_create();
+    if (http_tfd >= 0 && evl_add(&http_loop, http_tfd, EPOLLIN, http_on_idle, NULL) != 0) {
+        close(http_tfd);
+        http_tfd = -1;
+    }
+    http_idle_armed = 0;
+    for (int i=0;i<2;++i) {
+        if (socks[i]<0) continue;
+        fcntl(socks[i], F_SETFL, fcntl(socks[i], F_GETFL, 0) | O_NONBLOCK);
+        if (evl_add(&http_loop, socks[i], EPOLLIN, http_on_accept, NULL) != 0) {
+            fprintf(stderr,"[ERROR] evl_add(%s): %s\n", ifaces[i], strerror(errno));
+        }
+    }
+    evl_run(&http_loop); /* jusqu'à conf_stop() */
+
+    for (int i = 0; i < CONF_MAX_CONN; ++i) if (conns[i].fd >= 0) http_conn_close(&conns[i]);
+    if (http_tfd >= 0) close(http_tfd);
+    http_tfd = -1;
     for (int i=0;i<2;++i) if (socks[i]>=0) close(socks[i]);
     fprintf(stdout, "[INFO] CONF HTTP arrêté.\n");
     return NULL;
@@ -504,11 +926,16 @@ if (strcmp(method,"POST")==0 && strcmp(path,"/apply")==0) {
 int conf_start(uint16_t port) {
     if (server_running) return 0;
     server_port = port;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    http_boot_id = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    if (evl_init(&http_loop) != 0) return -1;
     server_running = 1;
     int rc = pthread_create(&server_thread, NULL, http_thread, NULL);
     if (rc != 0) {
-        fprintf(stderr, "[ERROR] pthread_create: %s\n", strerror(errno));
+        fprintf(stderr, "[ERROR] pthread_create: %s\n", strerror(rc));
         server_running = 0;
+        evl_close(&http_loop);
         return -1;
     }
     return 0;
@@ -517,17 +944,9 @@ int conf_start(uint16_t port) {
 void conf_stop(void) {
     if (!server_running) return;
     server_running = 0;
-
-    /* Poke: connecte sur les deux IP pour réveiller select/accept */
-    int s = socket(AF_INET, SOCK_STREAM, 0);
-    if (s >= 0) {
-        struct sockaddr_in a; memset(&a,0,sizeof(a));
-        a.sin_family = AF_INET; a.sin_port = htons(server_port);
-        a.sin_addr.s_addr = inet_addr(CONF_IFACE_ETH0); (void)connect(s,(struct sockaddr*)&a,sizeof(a));
-        a.sin_addr.s_addr = inet_addr(CONF_IFACE_USB0); (void)connect(s,(struct sockaddr*)&a,sizeof(a));
-        close(s);
-    }
+    evl_stop(&http_loop); /* réveille epoll_wait (eventfd) */
     pthread_join(server_thread, NULL);
+    evl_close(&http_loop);
 }
 
 int conf_need_reload(void) { return reload_flag ? 1 : 0; }
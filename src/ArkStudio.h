@@ -19,6 +19,11 @@ void conf_clear_reload_flag(void);
 /* Ajoute une entrée dans le journal MMS (exposée via GET /logs). */
 void conf_add_log(const char* action, const char* detail);
 
+/* Générateur JSON d'un endpoint: écrit au plus sz octets, retourne la longueur. */
+typedef int (*conf_json_fn)(char *buf, size_t sz);
+/* Enregistre GET path -> JSON (à appeler avant conf_start). Retour 0 si OK, -1 si table pleine. */
+int  conf_add_endpoint(const char *path, conf_json_fn fn);
+
 #ifdef __cplusplus
 }
 #endif
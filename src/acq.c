@@ -0,0 +1,201 @@
+// src/acq.c
+#include "acq.h"
+#include "cap.h"
+#include "lat.h"
+#include "scheduler.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+
+static acq_ring_t       ring;
+static pthread_t        acq_thread_id;
+static _Atomic int      acq_running = 0;
+static _Atomic int      acq_rate_hz = 100;
+static _Atomic uint64_t acq_produced = 0;
+static _Atomic uint64_t acq_missed   = 0;
+static cap_writer_t     acq_cap;
+static int              acq_cap_on   = 0;
+static _Atomic int      acq_cap_sync = 0;   // vidage demandé par acq_capture_sync()
+static acq_hook_fn      acq_hook     = NULL;
+static void            *acq_hook_ctx = NULL;
+static int              acq_policy   = SCHED_OTHER;
+static int              acq_priority = 0;
+static int              acq_cpu      = -1;
+
+static inline int64_t ts_to_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+static inline void ts_add_ns(struct timespec *ts, int64_t ns) {
+    int64_t t = ts_to_ns(ts) + ns;
+    ts->tv_sec  = (time_t)(t / 1000000000LL);
+    ts->tv_nsec = (long)(t % 1000000000LL);
+}
+
+/* -------------------- Ring SPSC -------------------- */
+
+void acq_ring_init(acq_ring_t *r) {
+    atomic_store(&r->head, 0);
+    atomic_store(&r->tail, 0);
+    atomic_store(&r->overruns, 0);
+    atomic_store(&r->underruns, 0);
+}
+
+int acq_ring_push(acq_ring_t *r, const acq_sample_t *s) {
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= ACQ_RING_SZ) {
+        atomic_fetch_add_explicit(&r->overruns, 1, memory_order_relaxed);
+        return -1; // plein: on perd l'échantillon le plus récent
+    }
+    r->buf[head & (ACQ_RING_SZ - 1)] = *s;
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+    return 0;
+}
+
+size_t acq_ring_pop(acq_ring_t *r, acq_sample_t *out, size_t max) {
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t avail = (size_t)(head - tail);
+    if (avail == 0) {
+        atomic_fetch_add_explicit(&r->underruns, 1, memory_order_relaxed);
+        return 0;
+    }
+    if (avail > max) avail = max;
+    for (size_t i = 0; i < avail; ++i) {
+        out[i] = r->buf[(tail + (uint32_t)i) & (ACQ_RING_SZ - 1)];
+    }
+    atomic_store_explicit(&r->tail, tail + (uint32_t)avail, memory_order_release);
+    return avail;
+}
+
+/* -------------------- Thread d'acquisition -------------------- */
+
+static void* acq_thread(void *arg) {
+    bea_t *bea = (bea_t*)arg;
+    aps_apply_policy("ACQ", acq_policy, acq_priority, acq_cpu);
+
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+
+    while (atomic_load(&acq_running)) {
+        int64_t period_ns = 1000000000LL / atomic_load(&acq_rate_hz);
+        ts_add_ns(&next, period_ns);
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR) { }
+        if (!atomic_load(&acq_running)) break;
+
+        // Une seule impulsion par tick pour toutes les voies: A et V dérivés de la même mesure
+        acq_sample_t s;
+        clock_gettime(CLOCK_MONOTONIC, &s.ts);
+        int rc = bea_read_block(bea, &s.blk);
+        lat_record(LAT_ACQ, lat_now_ns() - ts_to_ns(&s.ts));
+        if (rc < 0) { // échec global (ex: erreur GPIO): toutes les voies invalides
+            s.blk.nch = bea->nch;
+            for (int c = 0; c < s.blk.nch; ++c) {
+                s.blk.status[c] = rc;
+                s.blk.current_A[c] = s.blk.voltage_V[c] = (double)rc;
+            }
+        }
+        if (acq_hook) acq_hook(&s, acq_hook_ctx);
+        if (acq_ring_push(&ring, &s) == 0) {
+            atomic_fetch_add_explicit(&acq_produced, 1, memory_order_relaxed);
+        }
+        if (acq_cap_on) {
+            cap_writer_append(&acq_cap, ts_to_ns(&s.ts), s.blk.current_A, s.blk.voltage_V, s.blk.status);
+            if (atomic_exchange_explicit(&acq_cap_sync, 0, memory_order_relaxed)) cap_writer_sync(&acq_cap);
+        }
+
+        // Mesure plus longue qu'une période (ex: timeout ECHO): on saute les
+        // échéances passées plutôt que d'enchaîner des mesures en rafale.
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        while (ts_to_ns(&next) + period_ns <= ts_to_ns(&now)) {
+            ts_add_ns(&next, period_ns);
+            atomic_fetch_add_explicit(&acq_missed, 1, memory_order_relaxed);
+        }
+    }
+    return NULL;
+}
+
+/* -------------------- API publique -------------------- */
+
+int acq_capture_open(const char *path, int sample_rate_hz, int nch) {
+    if (atomic_load(&acq_running) || acq_cap_on) return -1;
+    if (cap_writer_open(&acq_cap, path, (uint32_t)sample_rate_hz, (uint32_t)nch) != 0) return -1;
+    acq_cap_on = 1;
+    fprintf(stdout, "[INFO] Capture des échantillons vers %s\n", path);
+    return 0;
+}
+
+void acq_capture_sync(void) {
+    if (acq_cap_on) atomic_store_explicit(&acq_cap_sync, 1, memory_order_relaxed);
+}
+
+void acq_set_hook(acq_hook_fn fn, void *ctx) {
+    if (atomic_load(&acq_running)) return;
+    acq_hook = fn;
+    acq_hook_ctx = ctx;
+}
+
+void acq_set_policy(int policy, int priority, int cpu) {
+    if (atomic_load(&acq_running) || policy < 0) return;
+    acq_policy   = policy;
+    acq_priority = priority;
+    acq_cpu      = cpu;
+}
+
+int acq_start(bea_t *bea, int sample_rate_hz) {
+    if (!bea) return -1;
+    if (atomic_load(&acq_running)) return 0;
+    acq_ring_init(&ring);
+    acq_set_rate(sample_rate_hz);
+    atomic_store(&acq_running, 1);
+    int rc = pthread_create(&acq_thread_id, NULL, acq_thread, bea);
+    if (rc != 0) {
+        fprintf(stderr, "[ERROR] pthread_create(acq): %s\n", strerror(rc));
+        atomic_store(&acq_running, 0);
+        return -1;
+    }
+    fprintf(stdout, "[INFO] Acquisition démarrée à %d Hz.\n", atomic_load(&acq_rate_hz));
+    return 0;
+}
+
+void acq_stop(void) {
+    if (!atomic_exchange(&acq_running, 0)) return;
+    pthread_join(acq_thread_id, NULL);
+    if (acq_cap_on) {
+        cap_writer_close(&acq_cap);
+        acq_cap_on = 0;
+    }
+}
+
+void acq_set_rate(int sample_rate_hz) {
+    if (sample_rate_hz <= 0) return;
+    atomic_store(&acq_rate_hz, sample_rate_hz);
+}
+
+size_t acq_drain(acq_sample_t *out, size_t max) {
+    return acq_ring_pop(&ring, out, max);
+}
+
+void acq_get_stats(acq_stats_t *st) {
+    if (!st) return;
+    st->produced     = atomic_load_explicit(&acq_produced, memory_order_relaxed);
+    st->overruns     = atomic_load_explicit(&ring.overruns, memory_order_relaxed);
+    st->underruns    = atomic_load_explicit(&ring.underruns, memory_order_relaxed);
+    st->missed_ticks = atomic_load_explicit(&acq_missed, memory_order_relaxed);
+    st->fill = atomic_load_explicit(&ring.head, memory_order_relaxed)
+             - atomic_load_explicit(&ring.tail, memory_order_relaxed);
+}
+
+int acq_build_json(char *buf, size_t sz) {
+    acq_stats_t st;
+    acq_get_stats(&st);
+    return snprintf(buf, sz,
+                    "{\n  \"rate_hz\": %d,\n  \"produced\": %llu,\n  \"overruns\": %llu,\n"
+                    "  \"underruns\": %llu,\n  \"missed_ticks\": %llu,\n  \"fill\": %u,\n  \"capacity\": %d\n}\n",
+                    atomic_load(&acq_rate_hz), (unsigned long long)st.produced,
+                    (unsigned long long)st.overruns, (unsigned long long)st.underruns,
+                    (unsigned long long)st.missed_ticks, (unsigned)st.fill, ACQ_RING_SZ);
+}
@@ -0,0 +1,98 @@
+// src/acq.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <stdalign.h>
+#include <time.h>
+#include "bea.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * ACQ: thread d'acquisition à cadence fixe (timer absolu CLOCK_MONOTONIC).
+ * - Le thread échantillonne le capteur à sample_rate_hz et pousse des
+ *   échantillons horodatés dans un ring SPSC sans verrou.
+ * - task_protection (consommateur unique) vide le ring sans jamais bloquer.
+ * Ainsi la gigue/les timeouts capteur ne rallongent plus le cycle APS.
+ * - Un crochet optionnel est appelé sur chaque échantillon dans le thread
+ *   d'acquisition, avant le ring (chemin de déclenchement rapide, cf. fast.h).
+ */
+
+#define ACQ_RING_SZ 1024   // doit être une puissance de 2
+
+typedef struct {
+    struct timespec ts;    // instant d'acquisition (CLOCK_MONOTONIC), commun aux voies
+    bea_block_t     blk;   // une mesure par voie (status[c] <0 = code d'erreur bea)
+} acq_sample_t;
+
+/* Ring SPSC: head écrit par le producteur seul, tail par le consommateur seul. */
+typedef struct {
+    acq_sample_t buf[ACQ_RING_SZ];
+    alignas(64) _Atomic uint32_t head;
+    alignas(64) _Atomic uint32_t tail;
+    alignas(64) _Atomic uint64_t overruns;   // échantillons perdus (ring plein)
+    _Atomic uint64_t underruns;              // lectures sur ring vide
+} acq_ring_t;
+
+/** Crochet par échantillon (thread d'acquisition): doit rester court et non bloquant. */
+typedef void (*acq_hook_fn)(const acq_sample_t *s, void *ctx);
+
+typedef struct {
+    uint64_t produced;     // échantillons poussés
+    uint64_t overruns;
+    uint64_t underruns;
+    uint64_t missed_ticks; // périodes sautées (acquisition plus longue que la période)
+    uint32_t fill;         // occupation instantanée du ring
+} acq_stats_t;
+
+/** Initialise un ring vide. */
+void   acq_ring_init(acq_ring_t *r);
+/** Producteur: pousse un échantillon. Retourne 0 si OK, -1 si plein (overrun compté). */
+int    acq_ring_push(acq_ring_t *r, const acq_sample_t *s);
+/** Consommateur: extrait jusqu'à max échantillons. 0 = ring vide (underrun compté). */
+size_t acq_ring_pop(acq_ring_t *r, acq_sample_t *out, size_t max);
+
+/**
+ * Active l'enregistrement binaire (format CAP, cf. cap.h) des échantillons
+ * produits, à appeler avant acq_start(). Écriture tamponnée (stdio 1 Mo) dans
+ * le thread d'acquisition; fermeture par acq_stop(). Retour 0 si OK.
+ */
+int    acq_capture_open(const char *path, int sample_rate_hz, int nch);
+/**
+ * Demande le vidage de la capture (tampon stdio et compteur de l'en-tête),
+ * effectué par le thread d'acquisition après son prochain échantillon. Non
+ * bloquant, appelé périodiquement hors temps réel: un arrêt brutal du
+ * processus ne perd que les échantillons depuis le dernier vidage.
+ */
+void   acq_capture_sync(void);
+
+/** Installe le crochet par échantillon (NULL = aucun), à appeler avant acq_start(). */
+void   acq_set_hook(acq_hook_fn fn, void *ctx);
+
+/**
+ * Politique (SCHED_*), priorité et CPU du thread d'acquisition, à appeler
+ * avant acq_start() (défaut: SCHED_OTHER, non épinglé). Le crochet du chemin
+ * rapide s'y exécute: priorité au-dessus de la classe RT d'APS.
+ */
+void   acq_set_policy(int policy, int priority, int cpu);
+
+/** Démarre le thread d'acquisition sur bea à la cadence donnée. Retour 0 si OK. */
+int    acq_start(bea_t *bea, int sample_rate_hz);
+/** Arrête le thread (join). */
+void   acq_stop(void);
+/** Change la cadence à chaud (prise en compte au tick suivant). */
+void   acq_set_rate(int sample_rate_hz);
+
+/** Vide le ring global (non bloquant). Retourne le nombre d'échantillons copiés. */
+size_t acq_drain(acq_sample_t *out, size_t max);
+/** Compteurs du ring et du thread. */
+void   acq_get_stats(acq_stats_t *st);
+/** Compteurs en JSON (GET /acq). Retourne la longueur écrite. */
+int    acq_build_json(char *buf, size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,131 +1,488 @@
-
-// src/bea.c
-#include "bea.h"
-#include <unistd.h>
-#include <time.h>
-#include <stdio.h>
-#include <math.h>
-
-static inline void ts_now(struct timespec *ts) {
-    clock_gettime(CLOCK_MONOTONIC, ts);
-}
-
-int bea_init(struct gpiod_chip *chip, bea_t *bea) {
-    if (!chip || !bea) return -1;
-
-    bea->trig = gpiod_chip_get_line(chip, BEA_TRIG_LINE);
-    if (!bea->trig) { perror("BEA get TRIG"); return -1; }
-    if (gpiod_line_request_output(bea->trig, "bea_trig", 0) < 0) {
-        perror("BEA request_output TRIG"); return -1;
-    }
-
-    bea->echo = gpiod_chip_get_line(chip, BEA_ECHO_LINE);
-    if (!bea->echo) { perror("BEA get ECHO"); return -1; }
-    if (gpiod_line_request_input(bea->echo, "bea_echo") < 0) {
-        perror("BEA request_input ECHO"); return -1;
-    }
-
-    // Calibration par défaut: "pulse_us" → valeurs fictives (à ajuster)
-    // Idée: 100 µs ≈ 10 A ; 100 µs ≈ 230 V (exemple, à affiner en essais)
-    bea->scale_current  = 0.10;  // 0.10 A par µs (donc 100 µs = 10 A)
-    bea->offset_current = 0.0;
-    bea->scale_voltage  = 2.30;  // 2.30 V par µs (donc 100 µs = 230 V)
-    bea->offset_voltage = 0.0;
-
-    return 0;
-}
-
-void bea_set_current_calib(bea_t *bea, double scale_A_per_us, double offset_A) {
-    bea->scale_current  = scale_A_per_us;
-    bea->offset_current = offset_A;
-}
-
-void bea_set_voltage_calib(bea_t *bea, double scale_V_per_us, double offset_V) {
-    bea->scale_voltage  = scale_V_per_us;
-    bea->offset_voltage = offset_V;
-}
-
-double bea_measure_pulse_us(bea_t *bea) {
-    if (!bea || !bea->trig || !bea->echo) return -1.0;
-
-    // Génère l’impulsion TRIG ~10µs
-    gpiod_line_set_value(bea->trig, 0);
-    usleep(2);
-    gpiod_line_set_value(bea->trig, 1);
-    usleep(10);
-    gpiod_line_set_value(bea->trig, 0);
-
-    // Attente du front montant ECHO (dans la limite d’un timeout)
-    struct timespec start, end;
-    int timeout = 0;
-    while (gpiod_line_get_value(bea->echo) == 0) {
-        ts_now(&start);
-        // petit sleep pour ne pas saturer CPU, mais garder réactivité
-        usleep(5);
-        if (++timeout > 60000) { // ~300 ms
-            return -2.0; // timeout avant front montant
-        }
-    }
-
-    // Mesure jusqu’au front descendant ECHO
-    timeout = 0;
-    while (gpiod_line_get_value(bea->echo) == 1) {
-        ts_now(&end);
-        usleep(5);
-        if (++timeout > 60000) { // ~300 ms
-            return -3.0; // timeout avant front descendant
-        }
-    }
-
-    double pulse_us = (end.tv_sec - start.tv_sec) * 1e6
-                    + (end.tv_nsec - start.tv_nsec) / 1e3;
-    if (pulse_us < 0) return -4.0;
-    return pulse_us;
-}
-
-double bea_sample_current_A(bea_t *bea) {
-    double p = bea_measure_pulse_us(bea);
-    if (p < 0) return p; // code d’erreur négatif
-    return bea->scale_current * p + bea->offset_current;
-}
-
-double bea_sample_voltage_V(bea_t *bea) {
-    double p = bea_measure_pulse_us(bea);
-    if (p < 0) return p; // code d’erreur négatif
-    return bea->scale_voltage * p + bea->offset_voltage;
-}
-
-static double compute_rms(const double *buf, int n) {
-    if (n <= 0) return -1.0;
-    double sumsq = 0.0;
-    for (int i = 0; i < n; ++i) sumsq += buf[i] * buf[i];
-    return sqrt(sumsq / n);
-}
-
-double bea_rms_current_A(bea_t *bea, int samples, int sleep_between_samples_us) {
-    if (samples <= 0) return -1.0;
-    double acc[128];
-    if (samples > (int)(sizeof(acc)/sizeof(acc[0]))) return -2.0;
-
-    for (int i = 0; i < samples; ++i) {
-        double v = bea_sample_current_A(bea);
-        if (v < -1.0) return v; // relaie l’erreur
-        acc[i] = v;
-        if (sleep_between_samples_us > 0) usleep(sleep_between_samples_us);
-    }
-    return compute_rms(acc, samples);
-}
-
-double bea_rms_voltage_V(bea_t *bea, int samples, int sleep_between_samples_us) {
-    if (samples <= 0) return -1.0;
-    double acc[128];
-    if (samples > (int)(sizeof(acc)/sizeof(acc[0]))) return -2.0;
-
-    for (int i = 0; i < samples; ++i) {
-        double v = bea_sample_voltage_V(bea);
-        if (v < -1.0) return v; // relaie l’erreur
-        acc[i] = v;
-        if (sleep_between_samples_us > 0) usleep(sleep_between_samples_us);
-    }
-    return compute_rms(acc, samples);
-}
+
+// src/bea.c
+#include "bea.h"
+#include <unistd.h>
+#include <time.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gpiod.h>
+#include <math.h>
+
+static inline void ts_now(struct timespec *ts) {
+    clock_gettime(CLOCK_MONOTONIC, ts);
+}
+
+/* -------------------- Backend matériel (HC-SR04, N voies) -------------------- */
+
+/*
+ * Lignes TRIG/ECHO de toutes les voies, demandées en bulk: un seul appel
+ * système pour tirer les TRIG et un seul pour attendre les fronts ECHO.
+ * L'indice d'une ligne dans le bulk est l'indice de voie.
+ */
+typedef struct {
+    struct gpiod_line_bulk trig;
+    struct gpiod_line_bulk echo;
+} hw_ctx_t;
+
+static int  hw_read(bea_t *bea, bea_block_t *out);
+
+static void hw_close(bea_t *bea) {
+    hw_ctx_t *hw = (hw_ctx_t*)bea->backend_ctx;
+    if (!hw) return;
+    gpiod_line_release_bulk(&hw->trig);
+    gpiod_line_release_bulk(&hw->echo);
+    free(hw);
+}
+
+static const bea_backend_t bea_backend_hw = { "hardware", hw_read, hw_close };
+
+/* Calibration par défaut commune à tous les backends */
+static int default_calib(bea_t *bea) {
+    bea_calib_t *set = (bea_calib_t*)malloc(sizeof(*set));
+    if (!set) return -1;
+    // Calibration par défaut: "pulse_us" → valeurs fictives (à ajuster)
+    // Idée: 100 µs ≈ 10 A ; 100 µs ≈ 230 V (exemple, à affiner en essais)
+    for (int c = 0; c < BEA_MAX_CH; ++c) {
+        calib_build_linear(&set->current[c], BEA_CALIB_A_PER_US, 0.0);  // 0.10 A par µs (donc 100 µs = 10 A)
+        calib_build_linear(&set->voltage[c], BEA_CALIB_V_PER_US, 0.0);  // 2.30 V par µs (donc 100 µs = 230 V)
+    }
+    atomic_init(&bea->calib, set);
+    atomic_init(&bea->calib_seq, 0);
+    bea->calib_rd = NULL;
+    memset(bea->retired, 0, sizeof(bea->retired));
+    return 0;
+}
+
+static void free_calib(bea_t *bea) {
+    for (int i = 0; i < BEA_CALIB_RETIRED; ++i) {
+        free(bea->retired[i]);
+        bea->retired[i] = NULL;
+    }
+    free(atomic_exchange(&bea->calib, NULL));
+}
+
+/* Jeu de calibration du lecteur: figé pendant une mesure (bea_read_block). */
+static inline const bea_calib_t *reader_calib(const bea_t *bea) {
+    return bea->calib_rd ? bea->calib_rd : atomic_load(&((bea_t*)bea)->calib);
+}
+
+static int request_echo(hw_ctx_t *hw, bea_capture_t mode) {
+    return (mode == BEA_CAPTURE_EVENT)
+         ? gpiod_line_request_bulk_both_edges_events(&hw->echo, "bea_echo")
+         : gpiod_line_request_bulk_input(&hw->echo, "bea_echo");
+}
+
+int bea_init(struct gpiod_chip *chip, bea_t *bea) {
+    const unsigned trig = BEA_TRIG_LINE, echo = BEA_ECHO_LINE;
+    return bea_init_multi(chip, bea, 1, &trig, &echo);
+}
+
+int bea_init_multi(struct gpiod_chip *chip, bea_t *bea, int nch,
+                   const unsigned *trig_lines, const unsigned *echo_lines) {
+    if (!chip || !bea || !trig_lines || !echo_lines || nch <= 0 || nch > BEA_MAX_CH) return -1;
+
+    hw_ctx_t *hw = (hw_ctx_t*)calloc(1, sizeof(*hw));
+    if (!hw) return -1;
+    unsigned offs[BEA_MAX_CH];
+
+    memcpy(offs, trig_lines, (size_t)nch * sizeof(offs[0]));
+    if (gpiod_chip_get_lines(chip, offs, (unsigned)nch, &hw->trig) < 0) {
+        perror("BEA get TRIG"); free(hw); return -1;
+    }
+    int zeros[BEA_MAX_CH] = {0};
+    if (gpiod_line_request_bulk_output(&hw->trig, "bea_trig", zeros) < 0) {
+        perror("BEA request_output TRIG"); free(hw); return -1;
+    }
+
+    memcpy(offs, echo_lines, (size_t)nch * sizeof(offs[0]));
+    if (gpiod_chip_get_lines(chip, offs, (unsigned)nch, &hw->echo) < 0) {
+        perror("BEA get ECHO");
+        gpiod_line_release_bulk(&hw->trig); free(hw); return -1;
+    }
+    if (request_echo(hw, BEA_CAPTURE_EVENT) == 0) {
+        bea->capture = BEA_CAPTURE_EVENT;
+    } else {
+        perror("BEA request_both_edges_events ECHO (repli en POLL)");
+        if (request_echo(hw, BEA_CAPTURE_POLL) < 0) {
+            perror("BEA request_input ECHO");
+            gpiod_line_release_bulk(&hw->trig); free(hw); return -1;
+        }
+        bea->capture = BEA_CAPTURE_POLL;
+    }
+
+    if (default_calib(bea) != 0) {
+        gpiod_line_release_bulk(&hw->trig);
+        gpiod_line_release_bulk(&hw->echo);
+        free(hw);
+        return -1;
+    }
+    bea->backend     = &bea_backend_hw;
+    bea->backend_ctx = hw;
+    bea->nch         = nch;
+    if (nch > 1) {
+        fprintf(stdout, "[INFO] BEA: %d voies TRIG/ECHO (bulk, %s)\n",
+                nch, bea->capture == BEA_CAPTURE_EVENT ? "événements" : "scrutation");
+    }
+    return 0;
+}
+
+int bea_init_backend(bea_t *bea, const bea_backend_t *backend, void *ctx, int nch) {
+    if (!bea || !backend || nch <= 0 || nch > BEA_MAX_CH) return -1;
+    if (default_calib(bea) != 0) return -1;
+    bea->backend = backend;
+    bea->backend_ctx = ctx;
+    bea->nch = nch;
+    return 0;
+}
+
+void bea_close(bea_t *bea) {
+    if (!bea || !bea->backend) return;
+    if (bea->backend->close) bea->backend->close(bea);
+    bea->backend = NULL;
+    bea->backend_ctx = NULL;
+    free_calib(bea);
+}
+
+const char *bea_backend_name(const bea_t *bea) {
+    return (bea && bea->backend) ? bea->backend->name : "none";
+}
+
+int bea_set_capture_mode(bea_t *bea, bea_capture_t mode) {
+    if (!bea || bea->backend != &bea_backend_hw) return -1;
+    if (bea->capture == mode) return 0;
+    hw_ctx_t *hw = (hw_ctx_t*)bea->backend_ctx;
+
+    gpiod_line_release_bulk(&hw->echo);
+    if (request_echo(hw, mode) == 0) {
+        bea->capture = mode;
+        return 0;
+    }
+    perror("BEA set_capture_mode");
+    // Restaure le mode précédent pour ne pas laisser ECHO non demandées
+    request_echo(hw, bea->capture);
+    return -1;
+}
+
+/* -------------------- Calibration (publication RCU) -------------------- */
+
+int bea_set_current_calib(bea_t *bea, double scale_A_per_us, double offset_A) {
+    bea_calib_t *set = bea_calib_edit(bea);
+    if (!set) return -1;
+    for (int c = 0; c < BEA_MAX_CH; ++c) calib_build_linear(&set->current[c], scale_A_per_us, offset_A);
+    if (bea_calib_publish(bea, set) != 0) { free(set); return -1; }
+    return 0;
+}
+
+int bea_set_voltage_calib(bea_t *bea, double scale_V_per_us, double offset_V) {
+    bea_calib_t *set = bea_calib_edit(bea);
+    if (!set) return -1;
+    for (int c = 0; c < BEA_MAX_CH; ++c) calib_build_linear(&set->voltage[c], scale_V_per_us, offset_V);
+    if (bea_calib_publish(bea, set) != 0) { free(set); return -1; }
+    return 0;
+}
+
+bea_calib_t *bea_calib_edit(const bea_t *bea) {
+    if (!bea) return NULL;
+    const bea_calib_t *cur = atomic_load(&((bea_t*)bea)->calib);
+    if (!cur) return NULL;
+    bea_calib_t *set = (bea_calib_t*)malloc(sizeof(*set));
+    if (set) memcpy(set, cur, sizeof(*set));
+    return set;
+}
+
+/*
+ * Période de grâce: le lecteur rend calib_seq impair pendant une mesure.
+ * Après l'échange, si calib_seq est pair aucune mesure ne peut encore tenir
+ * l'ancien jeu; sinon on attend que calib_seq change (fin de cette mesure).
+ */
+void bea_calib_reclaim(bea_t *bea) {
+    if (!bea) return;
+    uint32_t seq = atomic_load(&bea->calib_seq);
+    for (int i = 0; i < BEA_CALIB_RETIRED; ++i) {
+        if (bea->retired[i] && bea->retired_seq[i] != seq) {
+            free(bea->retired[i]);
+            bea->retired[i] = NULL;
+        }
+    }
+}
+
+int bea_calib_publish(bea_t *bea, bea_calib_t *set) {
+    if (!bea || !set) return -1;
+    bea_calib_reclaim(bea);
+
+    // Place de retrait réservée avant l'échange (écrivain unique): file pleine
+    // (mesure bloquée sur un timeout ECHO) = rien publié, l'appelant réessaie.
+    int slot = 0;
+    while (slot < BEA_CALIB_RETIRED && bea->retired[slot]) slot++;
+    if (slot == BEA_CALIB_RETIRED) return -2;
+
+    bea_calib_t *old = atomic_exchange(&bea->calib, set);
+    if (!old) return 0;
+    uint32_t seq = atomic_load(&bea->calib_seq);
+    if ((seq & 1u) == 0) {
+        free(old); // aucune mesure en cours
+        return 0;
+    }
+    bea->retired[slot]     = old;
+    bea->retired_seq[slot] = seq;
+    return 0;
+}
+
+static void trig_pulse(hw_ctx_t *hw) {
+    // Génère l’impulsion TRIG ~10µs, toutes voies ensemble
+    static const int lo[BEA_MAX_CH] = {0};
+    int hi[BEA_MAX_CH];
+    for (int c = 0; c < BEA_MAX_CH; ++c) hi[c] = 1; // quel que soit BEA_MAX_CH
+    gpiod_line_set_value_bulk(&hw->trig, lo);
+    usleep(2);
+    gpiod_line_set_value_bulk(&hw->trig, hi);
+    usleep(10);
+    gpiod_line_set_value_bulk(&hw->trig, lo);
+}
+
+static inline int64_t ts_to_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+/* Voie d'une ligne ECHO (indice dans le bulk), -1 si inconnue. */
+static int echo_channel(hw_ctx_t *hw, const struct gpiod_line *line) {
+    unsigned n = gpiod_line_bulk_num_lines(&hw->echo);
+    for (unsigned i = 0; i < n; ++i) {
+        if (gpiod_line_bulk_get_line(&hw->echo, i) == line) return (int)i;
+    }
+    return -1;
+}
+
+/* Vide les événements résiduels (fronts d'une mesure précédente avortée). */
+static void drain_echo_events(hw_ctx_t *hw) {
+    struct timespec zero = {0, 0};
+    struct gpiod_line_bulk ev_bulk;
+    struct gpiod_line_event ev;
+    while (gpiod_line_event_wait_bulk(&hw->echo, &zero, &ev_bulk) == 1) {
+        unsigned n = gpiod_line_bulk_num_lines(&ev_bulk);
+        for (unsigned i = 0; i < n; ++i) {
+            if (gpiod_line_event_read(gpiod_line_bulk_get_line(&ev_bulk, i), &ev) < 0) return;
+        }
+    }
+}
+
+/*
+ * Mode EVENT: un seul poll() sur les fd de toutes les voies ECHO par réveil.
+ * Chaque voie a son échéance: T après le TRIG pour le front montant, T après
+ * son propre front montant pour le descendant (comme en voie unique).
+ */
+static int measure_block_event(bea_t *bea, hw_ctx_t *hw, bea_block_t *out) {
+    const int64_t tmo_ns = (int64_t)BEA_ECHO_TIMEOUT_US * 1000;
+    struct timespec rise[BEA_MAX_CH];
+    int64_t deadline[BEA_MAX_CH];
+    int nch = bea->nch, pending = nch;
+    struct timespec now;
+
+    drain_echo_events(hw);
+    trig_pulse(hw);
+
+    ts_now(&now);
+    for (int c = 0; c < nch; ++c) {
+        out->status[c] = -2;   // en attente du front montant
+        deadline[c] = ts_to_ns(&now) + tmo_ns;
+    }
+
+    while (pending > 0) {
+        ts_now(&now);
+        int64_t t = ts_to_ns(&now), next = INT64_MAX;
+        for (int c = 0; c < nch; ++c) {
+            if (deadline[c] == INT64_MAX) continue;  // voie terminée
+            if (deadline[c] <= t) {                   // timeout: statut -2 ou -3 figé
+                deadline[c] = INT64_MAX;
+                pending--;
+                continue;
+            }
+            if (deadline[c] < next) next = deadline[c];
+        }
+        if (pending <= 0 || next == INT64_MAX) break;
+
+        int64_t left_ns = next - t;
+        struct timespec tmo = { .tv_sec  = left_ns / 1000000000LL,
+                                .tv_nsec = left_ns % 1000000000LL };
+        struct gpiod_line_bulk ev_bulk;
+        int rc = gpiod_line_event_wait_bulk(&hw->echo, &tmo, &ev_bulk);
+        if (rc < 0) return -1;
+        if (rc == 0) continue; // réévalue les échéances
+
+        ts_now(&now);
+        unsigned n = gpiod_line_bulk_num_lines(&ev_bulk);
+        for (unsigned i = 0; i < n; ++i) {
+            struct gpiod_line *line = gpiod_line_bulk_get_line(&ev_bulk, i);
+            struct gpiod_line_event ev;
+            if (gpiod_line_event_read(line, &ev) < 0) return -1;
+            int c = echo_channel(hw, line);
+            if (c < 0 || deadline[c] == INT64_MAX) continue;
+
+            if (out->status[c] == -2 && ev.event_type == GPIOD_LINE_EVENT_RISING_EDGE) {
+                rise[c] = ev.ts;
+                out->status[c] = -3;   // en attente du front descendant
+                deadline[c] = ts_to_ns(&now) + tmo_ns;
+            } else if (out->status[c] == -3 && ev.event_type == GPIOD_LINE_EVENT_FALLING_EDGE) {
+                double pulse_us = (double)(ts_to_ns(&ev.ts) - ts_to_ns(&rise[c])) / 1e3;
+                out->pulse_us[c] = pulse_us;
+                out->status[c]   = (pulse_us < 0) ? -4 : 0;
+                deadline[c] = INT64_MAX;
+                pending--;
+            }
+            // front inattendu (ex: descendant d'un écho tardif) -> on continue d'attendre
+        }
+    }
+    return 0;
+}
+
+/* Mode POLL: une lecture groupée des ECHO toutes les ~5 µs. */
+static int measure_block_poll(bea_t *bea, hw_ctx_t *hw, bea_block_t *out) {
+    const int limit = BEA_ECHO_TIMEOUT_US / 5; // ~300 ms par front
+    struct timespec start[BEA_MAX_CH], now;
+    int rise_iter[BEA_MAX_CH];
+    int vals[BEA_MAX_CH];
+    int done[BEA_MAX_CH] = {0};
+    int nch = bea->nch, pending = nch;
+
+    trig_pulse(hw);
+    for (int c = 0; c < nch; ++c) out->status[c] = -2;
+
+    for (int iter = 0; pending > 0; ++iter) {
+        if (gpiod_line_get_value_bulk(&hw->echo, vals) < 0) return -1;
+        ts_now(&now);
+        for (int c = 0; c < nch; ++c) {
+            if (done[c]) continue;
+            if (out->status[c] == -2) {
+                if (vals[c] == 1) {
+                    start[c] = now;
+                    rise_iter[c] = iter;
+                    out->status[c] = -3;
+                } else if (iter > limit) {
+                    done[c] = 1; // timeout avant front montant
+                    pending--;
+                }
+            } else if (out->status[c] == -3) {
+                if (vals[c] == 0) {
+                    double pulse_us = (now.tv_sec - start[c].tv_sec) * 1e6
+                                    + (now.tv_nsec - start[c].tv_nsec) / 1e3;
+                    out->pulse_us[c] = pulse_us;
+                    out->status[c]   = (pulse_us < 0) ? -4 : 0;
+                    done[c] = 1;
+                    pending--;
+                } else if (iter - rise_iter[c] > limit) {
+                    done[c] = 1; // timeout avant front descendant
+                    pending--;
+                }
+            }
+        }
+        // petit sleep pour ne pas saturer CPU, mais garder réactivité
+        if (pending > 0) usleep(5);
+    }
+    return 0;
+}
+
+static int hw_read(bea_t *bea, bea_block_t *out) {
+    hw_ctx_t *hw = (hw_ctx_t*)bea->backend_ctx;
+    out->nch = bea->nch;
+    int rc = (bea->capture == BEA_CAPTURE_EVENT)
+           ? measure_block_event(bea, hw, out)
+           : measure_block_poll(bea, hw, out);
+    if (rc < 0) return rc;
+    for (int c = 0; c < out->nch; ++c) bea_calibrate(bea, out, c);
+    return 0;
+}
+
+int bea_read_block(bea_t *bea, bea_block_t *out) {
+    if (!bea || !bea->backend || !out) return -1;
+    atomic_fetch_add(&bea->calib_seq, 1);        // impair: mesure en cours
+    bea->calib_rd = atomic_load(&bea->calib);    // un seul jeu pour toute la rafale
+    int rc = bea->backend->read(bea, out);
+    bea->calib_rd = NULL;
+    atomic_fetch_add(&bea->calib_seq, 1);        // pair: ancien jeu libérable
+    return rc;
+}
+
+double bea_measure_pulse_us(bea_t *bea) {
+    bea_block_t blk;
+    if (bea_read_block(bea, &blk) < 0) return -1.0;
+    if (blk.status[0] < 0) return (double)blk.status[0];
+    return blk.pulse_us[0];
+}
+
+void bea_calibrate(const bea_t *bea, bea_block_t *blk, int ch) {
+    if (blk->status[ch] < 0) {
+        blk->current_A[ch] = blk->voltage_V[ch] = (double)blk->status[ch];
+        return;
+    }
+    const bea_calib_t *cal = reader_calib(bea);
+    blk->current_A[ch] = calib_eval(&cal->current[ch], blk->pulse_us[ch]);
+    blk->voltage_V[ch] = calib_eval(&cal->voltage[ch], blk->pulse_us[ch]);
+}
+
+double bea_pulse_from_current(const bea_t *bea, int ch, double current_A) {
+    return calib_inverse(&reader_calib(bea)->current[ch], current_A);
+}
+
+int bea_sample(bea_t *bea, bea_sample_t *out) {
+    bea_block_t blk;
+    if (!out) return -1;
+    int rc = bea_read_block(bea, &blk);
+    if (rc < 0) return rc;
+    if (blk.status[0] < 0) return blk.status[0];
+    out->pulse_us  = blk.pulse_us[0];
+    out->current_A = blk.current_A[0];
+    out->voltage_V = blk.voltage_V[0];
+    return 0;
+}
+
+double bea_sample_current_A(bea_t *bea) {
+    bea_sample_t s;
+    int rc = bea_sample(bea, &s);
+    if (rc < 0) return (double)rc; // code d’erreur négatif
+    return s.current_A;
+}
+
+double bea_sample_voltage_V(bea_t *bea) {
+    bea_sample_t s;
+    int rc = bea_sample(bea, &s);
+    if (rc < 0) return (double)rc; // code d’erreur négatif
+    return s.voltage_V;
+}
+
+// Sommes accumulées au fil de l'eau: pas de tampon, pas de limite de N.
+int bea_acquire(bea_t *bea, int samples, int sleep_between_samples_us, bea_reading_t *out) {
+    if (!bea || !out || samples <= 0) return -1;
+    double sum = 0.0, sumsq = 0.0, sqA = 0.0, sqV = 0.0;
+
+    for (int i = 0; i < samples; ++i) {
+        bea_sample_t s;
+        int rc = bea_sample(bea, &s);
+        if (rc < 0) return rc; // relaie l’erreur
+        sum   += s.pulse_us;
+        sumsq += s.pulse_us * s.pulse_us;
+        sqA   += s.current_A * s.current_A;
+        sqV   += s.voltage_V * s.voltage_V;
+        if (sleep_between_samples_us > 0) usleep(sleep_between_samples_us);
+    }
+
+    out->n             = samples;
+    out->pulse_mean_us = sum / samples;
+    out->pulse_rms_us  = sqrt(sumsq / samples);
+    out->rms_A = sqrt(sqA / samples);
+    out->rms_V = sqrt(sqV / samples);
+    return 0;
+}
+
+double bea_rms_current_A(bea_t *bea, int samples, int sleep_between_samples_us) {
+    bea_reading_t r;
+    int rc = bea_acquire(bea, samples, sleep_between_samples_us, &r);
+    return (rc < 0) ? (double)rc : r.rms_A;
+}
+
+double bea_rms_voltage_V(bea_t *bea, int samples, int sleep_between_samples_us) {
+    bea_reading_t r;
+    int rc = bea_acquire(bea, samples, sleep_between_samples_us, &r);
+    return (rc < 0) ? (double)rc : r.rms_V;
+}
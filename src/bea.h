@@ -1,59 +1,240 @@
-
-// src/bea.h
-#pragma once
-#include <gpiod.h>
-#include <stddef.h>
-
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-/**
- * BEA-like: acquisition "analogique" basée sur HC-SR04 (pulse width en µs),
- * puis mapping vers "courant" (A) ou "tension" (V) via une calibration linéaire.
- *
- * On garde tes lignes:
- *  - TRIG = line 20 (P9_41)
- *  - ECHO = line 16 (P9_15)
- */
-
-#define BEA_TRIG_LINE 20  // P9_41
-#define BEA_ECHO_LINE 16  // P9_15
-
-typedef struct {
-    struct gpiod_line *trig;
-    struct gpiod_line *echo;
-    // Calibration linéaire: value = scale * pulse_us + offset
-    double scale_current;   // A / µs
-    double offset_current;  // A
-    double scale_voltage;   // V / µs
-    double offset_voltage;  // V
-} bea_t;
-
-/** Initialise TRIG/ECHO en sortie/entrée et charge une calibration par défaut. */
-int bea_init(struct gpiod_chip *chip, bea_t *bea);
-
-/** Met à jour la calibration courant. */
-void bea_set_current_calib(bea_t *bea, double scale_A_per_us, double offset_A);
-
-/** Met à jour la calibration tension. */
-void bea_set_voltage_calib(bea_t *bea, double scale_V_per_us, double offset_V);
-
-/** Mesure brute: durée du pulse ECHO en microsecondes (retourne <0 si erreur/timeout). */
-double bea_measure_pulse_us(bea_t *bea);
-
-/** Convertit la mesure en courant (A) via la calibration. */
-double bea_sample_current_A(bea_t *bea);
-
-/** Convertit la mesure en tension (V) via la calibration. */
-double bea_sample_voltage_V(bea_t *bea);
-
-/** Calcule le RMS sur N échantillons (courant) avec un pas (usleep) entre samples (µs). */
-double bea_rms_current_A(bea_t *bea, int samples, int sleep_between_samples_us);
-
-/** Calcule le RMS sur N échantillons (tension). */
-double bea_rms_voltage_V(bea_t *bea, int samples, int sleep_between_samples_us);
-
-#ifdef __cplusplus
-}
-#endif
+// src/bea.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "calib.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * BEA-like: acquisition "analogique" basée sur HC-SR04 (pulse width en µs),
+ * puis mapping vers "courant" (A) ou "tension" (V) via une calibration linéaire.
+ *
+ * Multi-départs: N voies TRIG/ECHO déclarées en config. Les TRIG sont tirés et
+ * les ECHO lus par requêtes libgpiod groupées (bulk): un seul appel système par
+ * front pour toutes les voies. Les résultats reviennent en structure de
+ * tableaux (bea_block_t).
+ *
+ * Calibration: table linéaire par morceaux par voie et par grandeur (calib.h),
+ * publiée par échange atomique de pointeur (style RCU): une mise à jour
+ * (rechargement config depuis HTTP) ne bloque ni ne corrompt une mesure en
+ * cours; l'ancien jeu est libéré quand le lecteur est sorti de sa mesure.
+ *
+ * On garde tes lignes pour la voie 0:
+ *  - TRIG = line 20 (P9_41)
+ *  - ECHO = line 16 (P9_15)
+ */
+
+struct gpiod_chip;
+
+#define BEA_TRIG_LINE 20  // P9_41
+#define BEA_ECHO_LINE 16  // P9_15
+
+/* Nombre max de voies (départs) par carte */
+#define BEA_MAX_CH 8
+
+/* Timeout d'attente de chaque front ECHO (µs) */
+#define BEA_ECHO_TIMEOUT_US 300000  // ~300 ms
+
+/**
+ * Mode de capture de l'impulsion ECHO:
+ *  - POLL : scrutation gpiod_line_get_value() + usleep(5) (historique)
+ *  - EVENT: fronts montant/descendant horodatés par le noyau (line events),
+ *           le thread dort sur le fd de la ligne jusqu'au front ou au timeout.
+ */
+typedef enum {
+    BEA_CAPTURE_POLL  = 0,
+    BEA_CAPTURE_EVENT = 1,
+} bea_capture_t;
+
+/**
+ * Échantillon unique: une seule impulsion TRIG/ECHO, toutes les voies
+ * calibrées en sont dérivées (A et V ne diffèrent que par la calibration).
+ */
+typedef struct {
+    double pulse_us;   // mesure brute (µs)
+    double current_A;
+    double voltage_V;
+} bea_sample_t;
+
+/** Bloc multi-voies (structure de tableaux): une mesure par voie. */
+typedef struct {
+    int    nch;
+    double pulse_us[BEA_MAX_CH];
+    double current_A[BEA_MAX_CH];
+    double voltage_V[BEA_MAX_CH];
+    int    status[BEA_MAX_CH];    // 0 = OK, <0 = code d'erreur (-2/-3/-4)
+} bea_block_t;
+
+typedef struct bea_s bea_t;
+
+/** Jeu de calibration complet (toutes les voies), immuable une fois publié. */
+typedef struct {
+    calib_table_t current[BEA_MAX_CH];  // pulse_us -> A
+    calib_table_t voltage[BEA_MAX_CH];  // pulse_us -> V
+} bea_calib_t;
+
+#define BEA_CALIB_RETIRED 4
+#define BEA_CALIB_A_PER_US 0.10   // calibration linéaire par défaut: 100 µs = 10 A
+#define BEA_CALIB_V_PER_US 2.30   // 100 µs = 230 V
+
+/**
+ * Backend d'acquisition (vtable derrière bea_t), choisi à l'exécution:
+ *  - "hardware" : HC-SR04 via libgpiod (TRIG/ECHO groupés)
+ *  - "synthetic": générateur de formes d'onde (sinus + harmoniques + bruit + défaut)
+ *  - "replay"   : rejeu d'un fichier d'échantillons enregistrés
+ */
+typedef struct {
+    const char *name;
+    /** Une mesure sur toutes les voies (status par voie). Retourne 0 si OK, code <0 si échec global. */
+    int  (*read)(bea_t *bea, bea_block_t *out);
+    /** Libère les ressources du backend (lignes GPIO, mémoire, fichiers). */
+    void (*close)(bea_t *bea);
+} bea_backend_t;
+
+struct bea_s {
+    const bea_backend_t *backend;
+    void *backend_ctx;      // état privé du backend (lignes GPIO, synthétique, rejeu)
+    int   nch;              // nombre de voies
+    bea_capture_t capture;  // mode de capture effectif de ECHO
+
+    // Calibration publiée (lecteur: thread d'acquisition, écrivain: rechargement config)
+    _Atomic(bea_calib_t*) calib;
+    _Atomic uint32_t calib_seq;           // impair = mesure en cours (lecteur unique)
+    const bea_calib_t *calib_rd;          // jeu figé pour la mesure en cours (côté lecteur)
+    bea_calib_t *retired[BEA_CALIB_RETIRED];      // anciens jeux en attente de libération
+    uint32_t     retired_seq[BEA_CALIB_RETIRED];  // calib_seq au moment du retrait
+};
+
+/* Harmoniques simulées: rangs 2..BEA_SYNTH_MAX_HARM+1 */
+#define BEA_SYNTH_MAX_HARM 12
+
+/** Paramètres du backend synthétique. */
+typedef struct {
+    double freq_hz;                      // fondamental (ex: 50 Hz)
+    double current_rms_A;                // RMS du fondamental courant
+    double voltage_rms_V;                // RMS tension
+    double harm_pct[BEA_SYNTH_MAX_HARM]; // harmoniques courant rang 2.. (% du fondamental)
+    double noise_pct;                    // bruit gaussien (% du RMS)
+    double fault_at_s;                   // instant du défaut depuis le démarrage (<0 = aucun)
+    double fault_gain;                   // facteur appliqué au courant après le défaut
+    int    fault_ch;                     // voie en défaut (-1 = toutes)
+} bea_synth_cfg_t;
+
+/** Résultat d'une rafale: RMS calibrés + statistiques brutes de l'impulsion (voie 0). */
+typedef struct {
+    int    n;              // nombre d'impulsions de la rafale
+    double pulse_mean_us;  // moyenne brute (µs)
+    double pulse_rms_us;   // RMS brut (µs)
+    double rms_A;          // RMS courant (A)
+    double rms_V;          // RMS tension (V)
+} bea_reading_t;
+
+/**
+ * Initialise TRIG/ECHO (voie unique, lignes par défaut) et charge une calibration par défaut.
+ * ECHO est demandé en mode EVENT (deux fronts); si le noyau/driver refuse,
+ * repli automatique en entrée simple + mode POLL.
+ */
+int bea_init(struct gpiod_chip *chip, bea_t *bea);
+
+/** Idem pour nch voies: TRIG et ECHO demandés en bulk. Retourne 0 si OK, -1 sinon. */
+int bea_init_multi(struct gpiod_chip *chip, bea_t *bea, int nch,
+                   const unsigned *trig_lines, const unsigned *echo_lines);
+
+/** Backend synthétique (nch voies): aucun GPIO requis. Retourne 0 si OK, -1 sinon. */
+int bea_init_synthetic(bea_t *bea, int nch, const bea_synth_cfg_t *cfg);
+
+/**
+ * Backend rejeu: capture binaire CAP (mmap, cf. cap.h) ou fichier texte
+ * "t_ms,A0,V0[,A1,V1...]" par ligne (lignes '#' ignorées).
+ * loop=1 reboucle en fin de fichier. Le nombre de voies est celui du fichier.
+ */
+int bea_init_replay(bea_t *bea, const char *path, int loop);
+
+/** Branche un backend quelconque (utilisé par les backends synthétique/rejeu). */
+int bea_init_backend(bea_t *bea, const bea_backend_t *backend, void *ctx, int nch);
+
+/** Libère le backend courant. */
+void bea_close(bea_t *bea);
+
+/** Nom du backend courant ("hardware", "synthetic", "replay"). */
+const char *bea_backend_name(const bea_t *bea);
+
+/** Parse une liste "h2 h3 h4 ..." (% du fondamental). Retourne le nombre de valeurs lues. */
+int bea_synth_parse_harm(const char *s, double *pct, int max);
+
+/** Change le mode de capture des ECHO (re-demande les lignes). Retourne 0 si OK, -1 sinon. */
+int bea_set_capture_mode(bea_t *bea, bea_capture_t mode);
+
+/** Met à jour la calibration courant (linéaire, toutes voies). Retourne 0 si OK. */
+int bea_set_current_calib(bea_t *bea, double scale_A_per_us, double offset_A);
+
+/** Met à jour la calibration tension (linéaire, toutes voies). Retourne 0 si OK. */
+int bea_set_voltage_calib(bea_t *bea, double scale_V_per_us, double offset_V);
+
+/**
+ * Copie modifiable du jeu publié (NULL si allocation impossible).
+ * Un seul écrivain à la fois (pas de verrou côté écriture).
+ */
+bea_calib_t *bea_calib_edit(const bea_t *bea);
+
+/**
+ * Publie un jeu (obtenu par bea_calib_edit) par échange atomique, sans
+ * attendre le lecteur: l'ancien jeu est libéré immédiatement si aucune mesure
+ * n'est en cours, sinon plus tard (bea_calib_reclaim). Retourne 0 si OK (le
+ * jeu appartient alors à bea), -2 si BEA_CALIB_RETIRED anciens jeux attendent
+ * encore la fin d'une mesure: rien n'est publié, le jeu reste à l'appelant
+ * qui réessaie plus tard. -1 si argument invalide.
+ */
+int bea_calib_publish(bea_t *bea, bea_calib_t *set);
+
+/** Libère les anciens jeux dont la période de grâce est écoulée (non bloquant). */
+void bea_calib_reclaim(bea_t *bea);
+
+/**
+ * Mesure brute (voie 0): durée du pulse ECHO en microsecondes.
+ * Retourne <0 si erreur: -1 argument, -2 timeout front montant,
+ * -3 timeout front descendant, -4 durée négative.
+ */
+double bea_measure_pulse_us(bea_t *bea);
+
+/** Une mesure sur toutes les voies (SoA). Retourne 0 si OK, code <0 si échec global. */
+int bea_read_block(bea_t *bea, bea_block_t *out);
+
+/** Une mesure du backend (voie 0) -> pulse brut + A + V. Retourne 0 si OK, code <0 (-2/-3/-4) sinon. */
+int bea_sample(bea_t *bea, bea_sample_t *out);
+
+/** Applique la calibration à la voie ch d'un bloc dont pulse_us est renseigné (backends, pendant bea_read_block). */
+void bea_calibrate(const bea_t *bea, bea_block_t *blk, int ch);
+
+/** Durée d'impulsion équivalente à un courant donné sur la voie ch (inverse de la calibration). */
+double bea_pulse_from_current(const bea_t *bea, int ch, double current_A);
+
+/**
+ * Une seule rafale de N impulsions pour toutes les voies calibrées: remplit out
+ * avec les RMS courant et tension de la voie 0.
+ * Retourne 0 si OK, code <0 sinon (relaie l'erreur de mesure).
+ */
+int bea_acquire(bea_t *bea, int samples, int sleep_between_samples_us, bea_reading_t *out);
+
+/** Convertit la mesure en courant (A) via la calibration. */
+double bea_sample_current_A(bea_t *bea);
+
+/** Convertit la mesure en tension (V) via la calibration. */
+double bea_sample_voltage_V(bea_t *bea);
+
+/**
+ * Calcule le RMS sur N échantillons (courant, N quelconque) avec un pas (usleep) entre samples (µs).
+ * Compat: déclenche sa propre rafale; préférer bea_acquire() pour obtenir A et V ensemble.
+ */
+double bea_rms_current_A(bea_t *bea, int samples, int sleep_between_samples_us);
+
+/** Calcule le RMS sur N échantillons (tension). Compat, cf. bea_acquire(). */
+double bea_rms_voltage_V(bea_t *bea, int samples, int sleep_between_samples_us);
+
+#ifdef __cplusplus
+}
+#endif
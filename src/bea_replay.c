@@ -0,0 +1,155 @@
+// src/bea_replay.c
+#include "bea.h"
+#include "cap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+/**
+ * Backend rejeu: relit en boucle des échantillons enregistrés.
+ *  - capture binaire CAP (cap.h): fichier mappé (mmap), aucune copie;
+ *  - texte, une ligne par échantillon: "t_ms,A0,V0[,A1,V1...]" (une paire
+ *    A/V par voie, nombre de voies fixé par la première ligne), chargé
+ *    entièrement à l'init (aucune E/S pendant l'acquisition).
+ * La cadence est celle du thread d'acquisition (temps réel); pour un rejeu
+ * plus rapide que le temps réel, voir l'outil replay (replay_main.c).
+ */
+
+typedef struct {
+    double t_ms;
+    double current_A[BEA_MAX_CH];
+    double voltage_V[BEA_MAX_CH];
+} replay_rec_t;
+
+typedef struct {
+    replay_rec_t *recs;    // format texte
+    cap_reader_t  cap;     // format binaire (mmap)
+    int    is_cap;
+    size_t count;
+    size_t pos;
+    int    loop;
+} replay_ctx_t;
+
+static int replay_read(bea_t *bea, bea_block_t *out) {
+    replay_ctx_t *c = (replay_ctx_t*)bea->backend_ctx;
+    if (c->pos >= c->count) {
+        if (!c->loop) return -1; // fin de fichier
+        c->pos = 0;
+    }
+    out->nch = bea->nch;
+    if (c->is_cap) {
+        const cap_record_t *r = cap_reader_record(&c->cap, c->pos++);
+        for (int ch = 0; ch < bea->nch; ++ch) {
+            out->status[ch] = cap_record_status(r, ch); // erreur capteur enregistrée
+            out->current_A[ch] = out->status[ch] < 0 ? out->status[ch] : r->ch[ch].current_A;
+            out->voltage_V[ch] = out->status[ch] < 0 ? out->status[ch] : r->ch[ch].voltage_V;
+        }
+    } else {
+        const replay_rec_t *r = &c->recs[c->pos++];
+        for (int ch = 0; ch < bea->nch; ++ch) {
+            out->status[ch]    = 0;
+            out->current_A[ch] = r->current_A[ch];
+            out->voltage_V[ch] = r->voltage_V[ch];
+        }
+    }
+    for (int ch = 0; ch < bea->nch; ++ch) {
+        out->pulse_us[ch] = bea_pulse_from_current(bea, ch, out->current_A[ch]);
+    }
+    return 0;
+}
+
+static void replay_close(bea_t *bea) {
+    replay_ctx_t *c = (replay_ctx_t*)bea->backend_ctx;
+    if (!c) return;
+    if (c->is_cap) cap_reader_close(&c->cap);
+    free(c->recs);
+    free(c);
+}
+
+static const bea_backend_t bea_backend_replay = { "replay", replay_read, replay_close };
+
+static int init_replay_cap(bea_t *bea, const char *path, int loop) {
+    replay_ctx_t *c = (replay_ctx_t*)calloc(1, sizeof(*c));
+    if (!c) return -1;
+    if (cap_reader_open(&c->cap, path) != 0) {
+        free(c);
+        return -1;
+    }
+    if (c->cap.count == 0) {
+        fprintf(stderr, "[ERROR] BEA replay: aucun échantillon dans %s\n", path);
+        cap_reader_close(&c->cap);
+        free(c);
+        return -1;
+    }
+    c->is_cap = 1;
+    c->count  = c->cap.count;
+    c->loop   = loop ? 1 : 0;
+    if (c->cap.nch > BEA_MAX_CH) {
+        fprintf(stderr, "[ERROR] BEA replay: %d voies > %d dans %s\n", c->cap.nch, BEA_MAX_CH, path);
+        cap_reader_close(&c->cap);
+        free(c);
+        return -1;
+    }
+    fprintf(stdout, "[INFO] BEA replay: %zu échantillons x %d voie(s) (capture %u Hz) depuis %s%s\n",
+            c->count, c->cap.nch, c->cap.hdr->sample_rate_hz, path, c->loop ? " (boucle)" : "");
+    return bea_init_backend(bea, &bea_backend_replay, c, c->cap.nch);
+}
+
+int bea_init_replay(bea_t *bea, const char *path, int loop) {
+    if (!bea || !path) return -1;
+    if (cap_is_capture_file(path)) return init_replay_cap(bea, path, loop);
+
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[ERROR] BEA replay: ouverture %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    replay_ctx_t *c = (replay_ctx_t*)calloc(1, sizeof(*c));
+    if (!c) { fclose(f); return -1; }
+    c->loop = loop ? 1 : 0;
+
+    size_t cap = 0;
+    int nch = 0;
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        replay_rec_t r;
+        double v[1 + 2 * BEA_MAX_CH];
+        int nv = 0;
+        if (line[0] == '#') continue;
+        for (char *p = line, *end; nv < 1 + 2 * BEA_MAX_CH; p = end) {
+            v[nv] = strtod(p, &end);
+            if (end == p) break;
+            nv++;
+            while (*end == ',' || *end == ' ') end++;
+        }
+        if (nv < 3) continue;
+        if (nch == 0) nch = (nv - 1) / 2;   // la première ligne fixe le nombre de voies
+        if ((nv - 1) / 2 < nch) continue;
+        r.t_ms = v[0];
+        for (int ch = 0; ch < nch; ++ch) {
+            r.current_A[ch] = v[1 + 2 * ch];
+            r.voltage_V[ch] = v[2 + 2 * ch];
+        }
+        if (c->count == cap) {
+            size_t ncap = cap ? cap * 2 : 4096;
+            replay_rec_t *nr = (replay_rec_t*)realloc(c->recs, ncap * sizeof(*nr));
+            if (!nr) break;
+            c->recs = nr;
+            cap = ncap;
+        }
+        c->recs[c->count++] = r;
+    }
+    fclose(f);
+
+    if (c->count == 0) {
+        fprintf(stderr, "[ERROR] BEA replay: aucun échantillon dans %s\n", path);
+        free(c->recs);
+        free(c);
+        return -1;
+    }
+    fprintf(stdout, "[INFO] BEA replay: %zu échantillons x %d voie(s) depuis %s%s\n",
+            c->count, nch, path, c->loop ? " (boucle)" : "");
+    return bea_init_backend(bea, &bea_backend_replay, c, nch);
+}
@@ -0,0 +1,107 @@
+// src/bea_synth.c
+#include "bea.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+/**
+ * Backend synthétique: génère courant/tension à partir du temps monotone
+ * écoulé depuis l'init (sinus + harmoniques + bruit gaussien + échelon de
+ * défaut), pour chaque voie. Permet de charger toute la chaîne de protection sans GPIO.
+ */
+
+typedef struct {
+    bea_synth_cfg_t cfg;
+    struct timespec t0;
+    uint64_t rng;        // état xorshift64*
+} synth_ctx_t;
+
+static double rng_uniform(uint64_t *s) {
+    uint64_t x = *s;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    *s = x;
+    return (double)((x * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/* Box-Muller: N(0,1) */
+static double rng_gauss(uint64_t *s) {
+    double u1 = rng_uniform(s), u2 = rng_uniform(s);
+    if (u1 < 1e-300) u1 = 1e-300;
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+static int synth_read(bea_t *bea, bea_block_t *out) {
+    synth_ctx_t *c = (synth_ctx_t*)bea->backend_ctx;
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double t = (double)(now.tv_sec - c->t0.tv_sec) + (double)(now.tv_nsec - c->t0.tv_nsec) / 1e9;
+    int fault = (c->cfg.fault_at_s >= 0.0 && t >= c->cfg.fault_at_s);
+
+    out->nch = bea->nch;
+    for (int ch = 0; ch < bea->nch; ++ch) {
+        // Voies déphasées de 120° (départs sur phases a, b, c successives)
+        double w = 2.0 * M_PI * c->cfg.freq_hz * t - 2.0 * M_PI / 3.0 * (ch % 3);
+
+        double i = sin(w);
+        for (int k = 0; k < BEA_SYNTH_MAX_HARM; ++k) {
+            if (c->cfg.harm_pct[k] != 0.0) i += c->cfg.harm_pct[k] / 100.0 * sin((k + 2) * w);
+        }
+        i *= M_SQRT2 * c->cfg.current_rms_A;
+        double v = M_SQRT2 * c->cfg.voltage_rms_V * sin(w);
+
+        if (fault && (c->cfg.fault_ch < 0 || c->cfg.fault_ch == ch)) i *= c->cfg.fault_gain;
+        if (c->cfg.noise_pct > 0.0) {
+            i += c->cfg.noise_pct / 100.0 * c->cfg.current_rms_A * rng_gauss(&c->rng);
+            v += c->cfg.noise_pct / 100.0 * c->cfg.voltage_rms_V * rng_gauss(&c->rng);
+        }
+
+        out->pulse_us[ch]  = bea_pulse_from_current(bea, ch, i);
+        out->current_A[ch] = i;
+        out->voltage_V[ch] = v;
+        out->status[ch]    = 0;
+    }
+    return 0;
+}
+
+static void synth_close(bea_t *bea) {
+    free(bea->backend_ctx);
+}
+
+static const bea_backend_t bea_backend_synth = { "synthetic", synth_read, synth_close };
+
+int bea_init_synthetic(bea_t *bea, int nch, const bea_synth_cfg_t *cfg) {
+    if (!bea || !cfg || cfg->freq_hz <= 0.0 || nch <= 0 || nch > BEA_MAX_CH) return -1;
+    synth_ctx_t *c = (synth_ctx_t*)calloc(1, sizeof(*c));
+    if (!c) return -1;
+    c->cfg = *cfg;
+    clock_gettime(CLOCK_MONOTONIC, &c->t0);
+    c->rng = 0x9E3779B97F4A7C15ULL ^ (uint64_t)c->t0.tv_nsec;
+    if (c->rng == 0) c->rng = 1;
+    fprintf(stdout, "[INFO] BEA synthétique: %d voie(s) f=%.1f Hz I=%.2f A V=%.2f V bruit=%.1f%% défaut@%.2fs x%.2f (voie %d)\n",
+            nch, cfg->freq_hz, cfg->current_rms_A, cfg->voltage_rms_V, cfg->noise_pct,
+            cfg->fault_at_s, cfg->fault_gain, cfg->fault_ch);
+    return bea_init_backend(bea, &bea_backend_synth, c, nch);
+}
+
+int bea_synth_parse_harm(const char *s, double *pct, int max) {
+    int n = 0;
+    if (!s) return 0;
+    while (*s && n < max) {
+        char *end;
+        double v = strtod(s, &end);
+        if (end == s) { s++; continue; } // séparateur (espace, ';')
+        pct[n++] = v;
+        s = end;
+    }
+    return n;
+}
@@ -8,13 +8,32 @@ int bel_init(struct gpiod_chip *chip, bel_t *bel, int line, int active_high) {
     if (!chip || !bel) return -1;
     bel->in = gpiod_chip_get_line(chip, line);
     if (!bel->in) { perror("BEL get_line"); return -1; }
-    if (gpiod_line_request_input(bel->in, "bel_in") < 0) {
-        perror("BEL request_input"); return -1;
+    bel->events = 1;
+    if (gpiod_line_request_both_edges_events(bel->in, "bel_in") < 0) {
+        perror("BEL request_both_edges_events");
+        bel->events = 0;
+        if (gpiod_line_request_input(bel->in, "bel_in") < 0) {
+            perror("BEL request_input"); return -1;
+        }
     }
     bel->active_high = active_high ? 1 : 0;
     return 0;
 }
 
+int bel_event_fd(bel_t *bel) {
+    if (!bel || !bel->in || !bel->events) return -1;
+    return gpiod_line_event_get_fd(bel->in);
+}
+
+int bel_event_read(bel_t *bel, struct timespec *ts) {
+    if (!bel || !bel->in || !bel->events) return -1;
+    struct gpiod_line_event ev;
+    if (gpiod_line_event_read(bel->in, &ev) < 0) return -1;
+    if (ts) *ts = ev.ts;
+    int v = (ev.event_type == GPIOD_LINE_EVENT_RISING_EDGE) ? 1 : 0;
+    return bel->active_high ? v : !v;
+}
+
 int bel_read(bel_t *bel) {
     if (!bel || !bel->in) return -1;
     int v = gpiod_line_get_value(bel->in);
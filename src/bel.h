@@ -3,6 +3,7 @@
 #pragma once
 #include <gpiod.h>
 #include <stdint.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,16 +12,30 @@ extern "C" {
 /**
  * BEL-like: lecture d’une entrée logique (TOR) avec anti-rebond logiciel.
  * Tu pourras passer n’importe quel line (ex. un bouton sur P8/P9).
+ * La ligne est demandée en événements sur les deux fronts quand le noyau le
+ * permet: bel_event_fd() s'enregistre alors dans un réacteur (cf. evl.h,
+ * aps_add_source) et bel_event_read() consomme le front horodaté, sans
+ * scrutation périodique.
  */
 
 typedef struct {
     struct gpiod_line *in;
     int active_high; // 1 si logique active-high, 0 si active-low
+    int events;      // 1 si demandée en événements (fronts), 0 en entrée simple
 } bel_t;
 
 /** Initialise la ligne en entrée (active_high contrôle la polarité logique). */
 int bel_init(struct gpiod_chip *chip, bel_t *bel, int line, int active_high);
 
+/** Descripteur des événements de front (pollable), -1 si ligne en entrée simple. */
+int bel_event_fd(bel_t *bel);
+
+/**
+ * Consomme un front: niveau logique (0/1, selon polarité) après le front et
+ * horodatage noyau dans *ts (si non NULL). Retourne -1 si erreur.
+ */
+int bel_event_read(bel_t *bel, struct timespec *ts);
+
 /** Lecture brute (0/1) selon polarité. Retourne -1 si erreur. */
 int bel_read(bel_t *bel);
 
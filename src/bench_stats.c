@@ -0,0 +1,97 @@
+// src/bench_stats.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+
+#include "stats.h"
+
+/**
+ * Microbenchmark du noyau de statistiques de bloc (stats.c): débit en
+ * échantillons/s pour chaque noyau disponible sur ce CPU, en double et en
+ * float, pour plusieurs tailles de fenêtre. Vérifie aussi que chaque noyau
+ * donne le même résultat que le scalaire.
+ *
+ * Usage: bench [duree_ms_par_mesure]
+ */
+
+#define BENCH_MS_DEFAULT 200
+#define BENCH_MAX_N      65536
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static const size_t sizes[] = { 64, 1024, 16384, BENCH_MAX_N };
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Répète le calcul pendant ~ms millisecondes; retourne le débit (échantillons/s). */
+static double run(const double *xd, const float *xf, size_t n, int use_f32, int ms, stats_block_t *st) {
+    double t0 = now_s(), t = t0;
+    unsigned long iters = 0;
+    while (t - t0 < ms / 1000.0) {
+        for (int k = 0; k < 16; ++k) {
+            if (use_f32) stats_block_f32(xf, n, st);
+            else         stats_block_f64(xd, n, st);
+        }
+        iters += 16;
+        t = now_s();
+    }
+    return (double)iters * (double)n / (t - t0);
+}
+
+static int close_to(double a, double b) {
+    return fabs(a - b) <= 1e-6 * (fabs(a) + fabs(b) + 1.0);
+}
+
+int main(int argc, char **argv)
+{
+    int ms = (argc > 1) ? atoi(argv[1]) : BENCH_MS_DEFAULT;
+    if (ms <= 0) ms = BENCH_MS_DEFAULT;
+
+    /* Signal de test: 50 Hz à 1 kHz, offset DC, 5e harmonique */
+    double *xd = (double*)malloc(BENCH_MAX_N * sizeof(double));
+    float  *xf = (float*)malloc(BENCH_MAX_N * sizeof(float));
+    if (!xd || !xf) return 1;
+    for (size_t i = 0; i < BENCH_MAX_N; ++i) {
+        double w = 2.0 * M_PI * 50.0 * (double)i / 1000.0;
+        xd[i] = 12.0 + 790.0 * sin(w) + 40.0 * sin(5.0 * w);
+        xf[i] = (float)xd[i];
+    }
+
+    stats_block_t ref[2], st;
+    stats_set_impl(STATS_IMPL_SCALAR);
+    stats_block_f64(xd, BENCH_MAX_N, &ref[0]);
+    stats_block_f32(xf, BENCH_MAX_N, &ref[1]);
+    printf("# référence n=%d: mean=%.4f min=%.3f max=%.3f var=%.3f rms=%.4f crête=%.4f\n",
+           BENCH_MAX_N, ref[0].mean, ref[0].min, ref[0].max, ref[0].var, ref[0].rms, ref[0].crest);
+    printf("# %-7s %-4s %8s %14s\n", "noyau", "type", "n", "échantillons/s");
+
+    for (int impl = STATS_IMPL_SCALAR; impl < STATS_IMPL_COUNT; ++impl) {
+        if (stats_set_impl((stats_impl_t)impl) != 0) continue;
+        for (int f32 = 0; f32 <= 1; ++f32) {
+            /* Contrôle de cohérence avec le scalaire */
+            if (f32) stats_block_f32(xf, BENCH_MAX_N, &st);
+            else     stats_block_f64(xd, BENCH_MAX_N, &st);
+            int ok = close_to(st.mean, ref[f32].mean) && close_to(st.var, ref[f32].var) &&
+                     st.min == ref[f32].min && st.max == ref[f32].max;
+
+            for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+                double rate = run(xd, xf, sizes[s], f32, ms, &st);
+                printf("  %-7s %-4s %8zu %14.3e%s\n", stats_impl_name((stats_impl_t)impl),
+                       f32 ? "f32" : "f64", sizes[s], rate, ok ? "" : "  ÉCART vs scalaire");
+            }
+        }
+    }
+
+    stats_set_impl(STATS_IMPL_AUTO);
+    printf("# noyau retenu (auto): %s\n", stats_impl_name(stats_get_impl()));
+    free(xd);
+    free(xf);
+    return 0;
+}
@@ -2,8 +2,25 @@
 // src/bom.c
 #include "bom.h"
 #include <stdint.h>
+#include <string.h>
 #include <time.h>
 
+/* Constantes de courbes: t(M) = TD*(A/(M^p-1)+B), r(M) = TD*tr/(1-M²) */
+typedef struct {
+  const char *name;
+  double a, b, p, tr;
+} bom_curve_def_t;
+
+static const bom_curve_def_t curve_defs[BOM_CURVE_COUNT] = {
+  [BOM_CURVE_DEFINITE] = { "definite", 0.0,    0.0,    0.0,  0.0  },
+  [BOM_CURVE_IEC_SI]   = { "iec_si",   0.14,   0.0,    0.02, 13.5 },
+  [BOM_CURVE_IEC_VI]   = { "iec_vi",   13.5,   0.0,    1.0,  47.3 },
+  [BOM_CURVE_IEC_EI]   = { "iec_ei",   80.0,   0.0,    2.0,  80.0 },
+  [BOM_CURVE_IEEE_MI]  = { "ieee_mi",  0.0515, 0.114,  0.02, 4.85 },
+  [BOM_CURVE_IEEE_VI]  = { "ieee_vi",  19.61,  0.491,  2.0,  21.6 },
+  [BOM_CURVE_IEEE_EI]  = { "ieee_ei",  28.2,   0.1217, 2.0,  29.1 },
+};
+
 static inline int64_t ts_diff_ms(const struct timespec *a, const struct timespec *b) {
   int64_t s  = (int64_t)a->tv_sec  - (int64_t)b->tv_sec;
   int64_t ns = (int64_t)a->tv_nsec - (int64_t)b->tv_nsec;
@@ -14,6 +31,7 @@ void bom_init(bom_t *bom, double threshold, int tms_ms) {
   bom->threshold  = threshold;
   bom->tms_ms     = tms_ms;
   bom->invalid    = 0;
+  bom->tms_running = 0;
   bom->tms_start  = (struct timespec){0}; // reset au démarrage
 }
 
@@ -25,22 +43,27 @@ int bom_check(bom_t *bom, double value) {
 int bom_check_with_tms(bom_t *bom, double value) {
   struct timespec now;
   clock_gettime(CLOCK_MONOTONIC, &now);
+  return bom_check_at(bom, value, &now);
+}
 
+int bom_check_at(bom_t *bom, double value, const struct timespec *now) {
   if (bom_check(bom, value)) {
     // printf("je suis la\n");
-    if (bom->tms_start.tv_sec == 0) {
+    if (!bom->tms_running) {
       // printf("je viens de commencer ici\n");
-      bom->tms_start = now;          // début temporisation
+      bom->tms_start = *now;         // début temporisation
+      bom->tms_running = 1;
     }
     // printf("je suis laa\n");
-    int64_t elapsed = ts_diff_ms(&now, &bom->tms_start);
+    int64_t elapsed = ts_diff_ms(now, &bom->tms_start);
     // printf("elapsed(ms)=%lld, tms(ms)=%d\n", (long long)elapsed, bom->tms_ms);
     int result=(elapsed >= bom->tms_ms) ? 1 : 0;
     // printf("resultat finale est=%d\n",result);
     return result;
   } else {
     // printf("je suis laaa\n");
-    bom->tms_start.tv_sec = 0;       // reset temporisation
+    bom->tms_running = 0;            // reset temporisation
+    bom->tms_start.tv_sec = 0;
     bom->tms_start.tv_nsec = 0;
     return 0;
   }
@@ -49,3 +72,19 @@ int bom_check_with_tms(bom_t *bom, double value) {
 void bom_set_invalid(bom_t *bom, int invalid) {
   bom->invalid = invalid ? 1 : 0;
 }
+
+int bom_curve_from_name(const char *name) {
+  for (int c = 0; c < BOM_CURVE_COUNT; ++c) {
+    if (name && strcmp(name, curve_defs[c].name) == 0) return c;
+  }
+  return -1;
+}
+
+int bom_curve_params(bom_curve_t curve, double *a, double *b, double *p, double *tr) {
+  if ((unsigned)curve >= BOM_CURVE_COUNT) return -1;
+  *a  = curve_defs[curve].a;
+  *b  = curve_defs[curve].b;
+  *p  = curve_defs[curve].p;
+  *tr = curve_defs[curve].tr;
+  return 0;
+}
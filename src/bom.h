@@ -10,11 +10,35 @@ extern "C" {
 /**
  * BOM-like: logique de calcul pour comparer RMS avec seuil,
  * gérer temporisation (TMS) et invalidité.
+ *
+ * Constantes des courbes de temporisation, M = valeur / seuil:
+ * - temps constant (BOM_CURVE_DEFINITE, défaut): tms_ms depuis le premier
+ *   dépassement, remise à zéro au premier retour sous le seuil;
+ * - temps inverse IEC 60255-151 / IEEE C37.112:
+ *     déclenchement  t(M) = TD * (A / (M^p - 1) + B)     (M > 1)
+ *     retour         r(M) = TD * tr / (1 - M²)           (M < 1)
+ *   M plafonné à BOM_M_MAX.
+ * Table indexée par bom_curve_t, une entrée par courbe (constantes à TD = 1).
  */
+
+typedef enum {
+  BOM_CURVE_DEFINITE = 0, // temps constant (tms_ms)
+  BOM_CURVE_IEC_SI,       // IEC normalement inverse
+  BOM_CURVE_IEC_VI,       // IEC très inverse
+  BOM_CURVE_IEC_EI,       // IEC extrêmement inverse
+  BOM_CURVE_IEEE_MI,      // IEEE modérément inverse
+  BOM_CURVE_IEEE_VI,      // IEEE très inverse
+  BOM_CURVE_IEEE_EI,      // IEEE extrêmement inverse
+  BOM_CURVE_COUNT
+} bom_curve_t;
+
+#define BOM_M_MAX 20.0    // au-delà, temps de déclenchement constant
+
 typedef struct {
   double threshold;      // Seuil (A ou V)
   int    tms_ms;         // Temporisation en millisecondes
   int    invalid;        // 0 = OK, 1 = invalide
+  int    tms_running;    // 1 = temporisation en cours
   struct timespec tms_start; // début de la temporisation (par instance)
 } bom_t;
 
@@ -24,9 +48,16 @@ void bom_init(bom_t *bom, double threshold, int tms_ms);
 int  bom_check(bom_t *bom, double value);
 /** Applique temporisation: retourne 1 si dépassement persistant >= tms_ms. */
 int  bom_check_with_tms(bom_t *bom, double value);
+/** Idem avec un instant fourni (CLOCK_MONOTONIC ou horodatage enregistré, ex. rejeu). */
+int  bom_check_at(bom_t *bom, double value, const struct timespec *now);
 /** Marque invalidité (ex: capteur HS). */
 void bom_set_invalid(bom_t *bom, int invalid);
 
+/** Courbe depuis son nom de config ("definite", "iec_si", ..., "ieee_ei"); -1 si inconnu. */
+int  bom_curve_from_name(const char *name);
+/** Constantes d'une courbe (A, B, p, tr à TD = 1). Retourne 0 si OK, -1 si courbe invalide. */
+int  bom_curve_params(bom_curve_t curve, double *a, double *b, double *p, double *tr);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,83 @@
+// src/calib.c
+#include "calib.h"
+#include <stdlib.h>
+#include <string.h>
+
+int calib_build(calib_table_t *t, const double *x, const double *y, int n) {
+    if (!t || !x || !y || n < 2 || n > CALIB_MAX_PTS) return -1;
+
+    // Tri par insertion (n <= 32) sur une copie
+    double px[CALIB_MAX_PTS], py[CALIB_MAX_PTS];
+    for (int i = 0; i < n; ++i) {
+        int j = i;
+        while (j > 0 && px[j - 1] > x[i]) {
+            px[j] = px[j - 1];
+            py[j] = py[j - 1];
+            j--;
+        }
+        px[j] = x[i];
+        py[j] = y[i];
+    }
+    for (int i = 1; i < n; ++i) {
+        if (px[i] <= px[i - 1]) return -1; // abscisses dupliquées
+    }
+
+    memset(t, 0, sizeof(*t));
+    t->nseg = n - 1;
+    memcpy(t->x, px, (size_t)n * sizeof(double));
+    for (int s = 0; s < t->nseg; ++s) {
+        t->b[s] = (py[s + 1] - py[s]) / (px[s + 1] - px[s]);
+        t->a[s] = py[s] - t->b[s] * px[s];
+    }
+
+    t->x0     = px[0];
+    t->inv_dx = (double)CALIB_CELLS / (px[n - 1] - px[0]);
+    int seg = 0;
+    for (int c = 0; c < CALIB_CELLS; ++c) {
+        double xc = t->x0 + (double)c / t->inv_dx;
+        while (seg < t->nseg - 1 && xc >= t->x[seg + 1]) seg++;
+        t->cell_seg[c] = (uint8_t)seg;
+    }
+    return 0;
+}
+
+void calib_build_linear(calib_table_t *t, double scale, double offset) {
+    const double x[2] = { 0.0, 1000.0 };
+    const double y[2] = { offset, scale * 1000.0 + offset };
+    calib_build(t, x, y, 2);
+}
+
+int calib_parse(calib_table_t *t, const char *s) {
+    double x[CALIB_MAX_PTS], y[CALIB_MAX_PTS];
+    int n = 0;
+    if (!s) return -1;
+    while (*s) {
+        char *end;
+        double px = strtod(s, &end);
+        if (end == s) { s++; continue; } // séparateur (espace, ';')
+        if (*end != ':') return -1;
+        s = end + 1;
+        double py = strtod(s, &end);
+        if (end == s) return -1;
+        if (n == CALIB_MAX_PTS) return -1;
+        x[n] = px;
+        y[n] = py;
+        n++;
+        s = end;
+    }
+    return calib_build(t, x, y, n);
+}
+
+double calib_inverse(const calib_table_t *t, double y) {
+    // Premier segment (monotone) qui contient y, sinon extrapolation
+    for (int s = 0; s < t->nseg; ++s) {
+        double y0 = t->a[s] + t->b[s] * t->x[s];
+        double y1 = t->a[s] + t->b[s] * t->x[s + 1];
+        if (t->b[s] != 0.0 && ((y >= y0 && y <= y1) || (y <= y0 && y >= y1))) {
+            return (y - t->a[s]) / t->b[s];
+        }
+    }
+    int s = (t->b[0] != 0.0 && y < t->a[0] + t->b[0] * t->x[0]) ? 0 : t->nseg - 1;
+    if (t->b[s] == 0.0) return t->x[s];
+    return (y - t->a[s]) / t->b[s];
+}
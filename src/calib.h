@@ -0,0 +1,59 @@
+// src/calib.h
+#pragma once
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * CALIB: calibration linéaire par morceaux pulse_us -> grandeur (A ou V).
+ *
+ * Les points (x croissants) sont précalculés en segments y = a + b*x et en
+ * une table dense de CALIB_CELLS cellules sur [x0, xN]: chaque cellule donne
+ * le segment de son début, la recherche est donc O(1) (au plus quelques
+ * points d'inflexion dans la cellule). Hors plage: extrapolation du premier
+ * ou du dernier segment.
+ */
+
+#define CALIB_MAX_PTS 32
+#define CALIB_CELLS   256
+
+typedef struct {
+    int     nseg;                    // nombre de segments (points - 1)
+    double  x[CALIB_MAX_PTS];        // abscisses (pulse_us), strictement croissantes
+    double  a[CALIB_MAX_PTS - 1];    // ordonnée à l'origine du segment
+    double  b[CALIB_MAX_PTS - 1];    // pente du segment
+    double  x0;                      // début de la table dense
+    double  inv_dx;                  // CALIB_CELLS / (xN - x0)
+    uint8_t cell_seg[CALIB_CELLS];   // segment au début de chaque cellule
+} calib_table_t;
+
+/** Construit la table à partir de n points (triés ou non). Retourne 0 si OK, -1 sinon. */
+int    calib_build(calib_table_t *t, const double *x, const double *y, int n);
+/** Table linéaire y = scale*x + offset. */
+void   calib_build_linear(calib_table_t *t, double scale, double offset);
+/** Parse "x:y x:y ..." (séparateur espace ou ';') et construit la table. Retourne 0 si OK. */
+int    calib_parse(calib_table_t *t, const char *s);
+
+/** Conversion O(1). */
+static inline double calib_eval(const calib_table_t *t, double x) {
+    double f = (x - t->x0) * t->inv_dx;
+    int seg;
+    if (f < 0.0) {
+        seg = 0;
+    } else if (f >= (double)CALIB_CELLS) {
+        seg = t->nseg - 1;
+    } else {
+        seg = t->cell_seg[(int)f];
+        while (seg < t->nseg - 1 && x >= t->x[seg + 1]) seg++;
+    }
+    return t->a[seg] + t->b[seg] * x;
+}
+
+/** Conversion inverse (grandeur -> pulse_us), pour les backends simulés. O(n). */
+double calib_inverse(const calib_table_t *t, double y);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+// src/cap.c
+#include "cap.h"
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/* -------------------- Écriture -------------------- */
+
+static void fill_header(const cap_writer_t *w, cap_header_t *h) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, CAP_MAGIC, sizeof(CAP_MAGIC));
+    h->version        = CAP_VERSION;
+    h->record_size    = (uint32_t)CAP_RECORD_SIZE(w->nch);
+    h->sample_rate_hz = w->sample_rate_hz;
+    h->nch            = w->nch;
+    h->count          = w->count;
+}
+
+static int write_header(cap_writer_t *w) {
+    cap_header_t h;
+    fill_header(w, &h);
+    return fwrite(&h, sizeof(h), 1, w->f) == 1 ? 0 : -1;
+}
+
+int cap_writer_open(cap_writer_t *w, const char *path, uint32_t sample_rate_hz, uint32_t nch) {
+    if (!w || !path || nch == 0 || nch > CAP_MAX_CH) return -1;
+    w->f = fopen(path, "wb");
+    if (!w->f) {
+        fprintf(stderr, "[ERROR] CAP: ouverture %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    setvbuf(w->f, NULL, _IOFBF, 1 << 20);
+    w->count = 0;
+    w->sample_rate_hz = sample_rate_hz;
+    w->nch = nch;
+    if (write_header(w) != 0) {
+        fclose(w->f);
+        w->f = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int cap_writer_append(cap_writer_t *w, int64_t t_ns, const double *current_A,
+                      const double *voltage_V, const int *status) {
+    if (!w || !w->f) return -1;
+    char raw[CAP_RECORD_SIZE(CAP_MAX_CH)];
+    memcpy(raw, &t_ns, sizeof(t_ns));
+    for (uint32_t c = 0; c < w->nch; ++c) {
+        cap_chan_t ch;
+        ch.current_A = (status[c] < 0) ? NAN : (float)current_A[c];
+        ch.voltage_V = (status[c] < 0) ? (float)status[c] : (float)voltage_V[c];
+        memcpy(raw + CAP_RECORD_SIZE(c), &ch, sizeof(ch));
+    }
+    if (fwrite(raw, CAP_RECORD_SIZE(w->nch), 1, w->f) != 1) return -1;
+    w->count++;
+    return 0;
+}
+
+int cap_writer_sync(cap_writer_t *w) {
+    if (!w || !w->f) return -1;
+    if (fflush(w->f) != 0) return -1;
+    /* Enregistrements d'abord, compteur ensuite: count <= enregistrements présents */
+    cap_header_t h;
+    fill_header(w, &h);
+    return pwrite(fileno(w->f), &h, sizeof(h), 0) == (ssize_t)sizeof(h) ? 0 : -1;
+}
+
+void cap_writer_close(cap_writer_t *w) {
+    if (!w || !w->f) return;
+    fflush(w->f);
+    if (fseek(w->f, 0, SEEK_SET) == 0) write_header(w);
+    fclose(w->f);
+    w->f = NULL;
+}
+
+/* -------------------- Lecture -------------------- */
+
+int cap_reader_open(cap_reader_t *r, const char *path) {
+    if (!r || !path) return -1;
+    memset(r, 0, sizeof(*r));
+    r->fd = open(path, O_RDONLY);
+    if (r->fd < 0) {
+        fprintf(stderr, "[ERROR] CAP: ouverture %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(r->fd, &st) != 0 || (size_t)st.st_size < sizeof(cap_header_t)) {
+        fprintf(stderr, "[ERROR] CAP: %s trop court\n", path);
+        close(r->fd);
+        r->fd = -1;
+        return -1;
+    }
+    r->map_len = (size_t)st.st_size;
+    r->map = mmap(NULL, r->map_len, PROT_READ, MAP_PRIVATE, r->fd, 0);
+    if (r->map == MAP_FAILED) {
+        fprintf(stderr, "[ERROR] CAP: mmap %s: %s\n", path, strerror(errno));
+        close(r->fd);
+        r->map = NULL;
+        r->fd = -1;
+        return -1;
+    }
+    posix_madvise(r->map, r->map_len, POSIX_MADV_SEQUENTIAL);
+
+    r->hdr = (const cap_header_t*)r->map;
+    r->nch = r->hdr->nch ? (int)r->hdr->nch : 1;
+    if (memcmp(r->hdr->magic, CAP_MAGIC, sizeof(CAP_MAGIC)) != 0 ||
+        r->hdr->version != CAP_VERSION || r->nch > CAP_MAX_CH ||
+        r->hdr->record_size != CAP_RECORD_SIZE(r->nch)) {
+        fprintf(stderr, "[ERROR] CAP: %s n'est pas une capture v%d\n", path, CAP_VERSION);
+        cap_reader_close(r);
+        return -1;
+    }
+
+    r->rec_size = r->hdr->record_size;
+    size_t avail = (r->map_len - sizeof(cap_header_t)) / r->rec_size;
+    r->count = (r->hdr->count && r->hdr->count <= avail) ? (size_t)r->hdr->count : avail;
+    r->recs  = (const char*)r->map + sizeof(cap_header_t);
+    return 0;
+}
+
+void cap_reader_close(cap_reader_t *r) {
+    if (!r) return;
+    if (r->map && r->map != MAP_FAILED) munmap(r->map, r->map_len);
+    if (r->fd >= 0) close(r->fd);
+    r->map = NULL;
+    r->fd = -1;
+    r->count = 0;
+}
+
+int cap_is_capture_file(const char *path) {
+    char magic[8] = {0};
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t n = fread(magic, 1, sizeof(magic), f);
+    fclose(f);
+    return n == sizeof(magic) && memcmp(magic, CAP_MAGIC, sizeof(CAP_MAGIC)) == 0;
+}
+
+int cap_record_status(const cap_record_t *rec, int ch) {
+    return isnan(rec->ch[ch].current_A) ? (int)rec->ch[ch].voltage_V : 0;
+}
@@ -0,0 +1,102 @@
+// src/cap.h
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * CAP: format binaire de capture d'échantillons A/V horodatés.
+ *
+ *  [cap_header_t][cap_record_t + nch x cap_chan_t][...]...
+ *
+ * - Entiers little-endian (cible BBB et x86), enregistrements de taille fixe
+ *   (record_size = 8 + 8*nch): le lecteur mappe le fichier (mmap) et l'indexe
+ *   directement (cap_reader_record()).
+ * - t_ns = CLOCK_MONOTONIC de l'acquisition (ns), commun à toutes les voies.
+ * - nch = 0 dans l'en-tête: capture voie unique antérieure au multi-départs.
+ * - Échantillon invalide: current_A = NaN, voltage_V = code d'erreur bea (-2/-3/-4).
+ * - count est réécrit à chaque cap_writer_sync() et à la fermeture; un fichier
+ *   non fermé reste lisible (le lecteur déduit alors le nombre
+ *   d'enregistrements de la taille).
+ */
+
+#define CAP_MAGIC   "BEACAP1"   // 7 caractères + '\0'
+#define CAP_VERSION 1
+#define CAP_MAX_CH  8           // = BEA_MAX_CH
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;     // CAP_RECORD_SIZE(nch)
+    uint32_t sample_rate_hz;  // cadence nominale d'acquisition
+    uint32_t nch;             // nombre de voies (0 = 1)
+    uint64_t count;           // nombre d'enregistrements
+} cap_header_t;               // 32 octets
+
+typedef struct {
+    float   current_A;
+    float   voltage_V;
+} cap_chan_t;                 // 8 octets
+
+typedef struct {
+    int64_t    t_ns;
+    cap_chan_t ch[];          // nch voies
+} cap_record_t;               // 8 octets + 8*nch
+
+#define CAP_RECORD_SIZE(nch) (sizeof(cap_record_t) + (size_t)(nch) * sizeof(cap_chan_t))
+
+/* -------- Écriture (tampon stdio, une écriture disque par ~64k échantillons) -------- */
+
+typedef struct {
+    FILE    *f;
+    uint64_t count;
+    uint32_t sample_rate_hz;
+    uint32_t nch;
+} cap_writer_t;
+
+/** Crée/tronque le fichier et écrit l'en-tête. Retourne 0 si OK, -1 sinon. */
+int  cap_writer_open(cap_writer_t *w, const char *path, uint32_t sample_rate_hz, uint32_t nch);
+/** Ajoute un échantillon de nch voies (status[c] <0 = voie invalide). Retourne 0 si OK, -1 sinon. */
+int  cap_writer_append(cap_writer_t *w, int64_t t_ns, const double *current_A,
+                       const double *voltage_V, const int *status);
+/**
+ * Vide le tampon stdio puis réécrit le compteur dans l'en-tête (position
+ * d'écriture inchangée). Même thread que cap_writer_append(). Retourne 0 si OK.
+ */
+int  cap_writer_sync(cap_writer_t *w);
+/** Réécrit le compteur dans l'en-tête et ferme. */
+void cap_writer_close(cap_writer_t *w);
+
+/* -------- Lecture mmap -------- */
+
+typedef struct {
+    int                 fd;
+    void               *map;
+    size_t              map_len;
+    const cap_header_t *hdr;
+    const char         *recs;     // premier enregistrement
+    size_t              rec_size;
+    size_t              count;
+    int                 nch;
+} cap_reader_t;
+
+/** Mappe un fichier de capture en lecture. Retourne 0 si OK, -1 sinon. */
+int  cap_reader_open(cap_reader_t *r, const char *path);
+/** Démappe et ferme. */
+void cap_reader_close(cap_reader_t *r);
+/** Vrai si le fichier commence par CAP_MAGIC. */
+int  cap_is_capture_file(const char *path);
+/** Enregistrement i (i < count). */
+static inline const cap_record_t *cap_reader_record(const cap_reader_t *r, size_t i) {
+    return (const cap_record_t*)(r->recs + i * r->rec_size);
+}
+/** Décode le statut d'une voie (0 = OK, <0 = code d'erreur). */
+int  cap_record_status(const cap_record_t *rec, int ch);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,11 +1,14 @@
 
 #include "config.h"
+#include "logic.h"
+#include "bom.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 #include <errno.h>
+#include <stdatomic.h>
 
 /* =======================
  * Stockage interne
@@ -16,16 +19,69 @@ static double thr_A    = DEFAULT_THRESHOLD_A;
 static double thr_V    = DEFAULT_THRESHOLD_V;
 static int    tms_A    = DEFAULT_TMS_A_MS;
 static int    tms_V    = DEFAULT_TMS_V_MS;
+static char   curve_A[16] = DEFAULT_CURVE;
+static char   curve_V[16] = DEFAULT_CURVE;
+static double time_dial_A = DEFAULT_TIME_DIAL;
+static double time_dial_V = DEFAULT_TIME_DIAL;
+static double ioc_pickup_A = DEFAULT_IOC_PICKUP_A;
+static int    ioc_delay_ms = DEFAULT_IOC_DELAY_MS;
+static double fast_pickup_A = DEFAULT_FAST_PICKUP_A;
+static int    fast_count    = DEFAULT_FAST_COUNT;
+static double uv_pickup_V  = DEFAULT_UV_PICKUP_V;
+static int    uv_delay_ms  = DEFAULT_UV_DELAY_MS;
 
 /* Commun */
 static int    samples  = DEFAULT_SAMPLES;
 static int    sleep_ms = DEFAULT_SLEEP_MS;
+static int    sample_rate_hz = DEFAULT_SAMPLE_RATE_HZ;
+static double nominal_freq_hz = DEFAULT_NOMINAL_FREQ_HZ;
+static int    harm_cycles    = DEFAULT_HARM_CYCLES;
+static int    filter_window  = DEFAULT_FILTER_WINDOW;
+static double outlier_tol    = DEFAULT_OUTLIER_TOL;
+static double max_loss_ratio = DEFAULT_MAX_LOSS_RATIO;
+
+/* Génération: incrémentée à chaque chargement (lue par le serveur CONF) */
+static _Atomic unsigned config_gen = 1;
 
 /* Compat historique */
 static char   mode[16] = DEFAULT_MODE;
 
 /* Logique de déclenchement (étendu) */
-static char   trip_logic[8] = DEFAULT_TRIP_LOGIC;
+static char   trip_logic[TRIP_LOGIC_MAX] = DEFAULT_TRIP_LOGIC;
+
+/* Backend d'acquisition */
+static char   backend[16]      = DEFAULT_BACKEND;
+static char   replay_file[128] = DEFAULT_REPLAY_FILE;
+static char   capture_file[128] = DEFAULT_CAPTURE_FILE;
+static int    replay_loop      = 1;
+static double synth_freq_hz    = DEFAULT_SYNTH_FREQ_HZ;
+static double synth_current_A  = DEFAULT_SYNTH_CURRENT_A;
+static double synth_voltage_V  = DEFAULT_SYNTH_VOLTAGE_V;
+static char   synth_harm_pct[64] = "";
+static double synth_noise_pct  = 0.0;
+static int    synth_fault_at_ms = -1;
+static double synth_fault_gain = 1.0;
+static int    synth_fault_ch   = -1;
+
+/* Ordonnancement APS: classes RT / NRT */
+static char   rt_policy[8]     = DEFAULT_RT_POLICY;
+static int    rt_priority      = DEFAULT_RT_PRIORITY;
+static int    rt_cpu           = DEFAULT_RT_CPU;
+static char   nrt_policy[8]    = DEFAULT_NRT_POLICY;
+static int    nrt_priority     = DEFAULT_NRT_PRIORITY;
+static int    nrt_cpu          = DEFAULT_NRT_CPU;
+static char   acq_policy[8]    = DEFAULT_ACQ_POLICY;
+static int    acq_priority     = DEFAULT_ACQ_PRIORITY;
+static int    acq_cpu          = DEFAULT_ACQ_CPU;
+
+/* Multi-départs */
+static int    channels         = DEFAULT_CHANNELS;
+static char   trig_lines[64]   = DEFAULT_TRIG_LINES;
+static char   echo_lines[64]   = DEFAULT_ECHO_LINES;
+
+/* Calibration: [0] = table commune, [1 + c] = surcharge de la voie c */
+static char   calib_A[1 + CONFIG_MAX_CHANNELS][256];
+static char   calib_V[1 + CONFIG_MAX_CHANNELS][256];
 
 /* =======================
  * Helpers internes
@@ -51,19 +107,84 @@ static char* unquote(char *s) {
     return s;
 }
 
+static void copy_str(char *dst, size_t sz, const char *src) {
+    strncpy(dst, src, sz-1);
+    dst[sz-1] = '\0';
+}
+
+/* "calib_A" -> 0, "calib_A_<c>" -> 1 + c, -1 si voie hors bornes. */
+static int calib_slot(const char *key, const char *name) {
+    const char *p = strstr(key, name) + strlen(name);
+    if (*p != '_') return 0;
+    int c = atoi(p + 1);
+    return (c >= 0 && c < CONFIG_MAX_CHANNELS) ? 1 + c : -1;
+}
+
+static int valid_policy(const char *p) {
+    return strcmp(p, "fifo") == 0 || strcmp(p, "rr") == 0 || strcmp(p, "other") == 0;
+}
+
 /* Applique des bornes raisonnables pour éviter valeurs aberrantes. */
 static void clamp_all(void) {
     if (thr_A < 0.0)    thr_A = DEFAULT_THRESHOLD_A;
     if (thr_V < 0.0)    thr_V = DEFAULT_THRESHOLD_V;
     if (tms_A <= 0)     tms_A = DEFAULT_TMS_A_MS;
     if (tms_V <= 0)     tms_V = DEFAULT_TMS_V_MS;
-    if (samples <= 0 || samples > 128) samples = DEFAULT_SAMPLES;
+    if (time_dial_A <= 0.0 || time_dial_A > 100.0) time_dial_A = DEFAULT_TIME_DIAL;
+    if (time_dial_V <= 0.0 || time_dial_V > 100.0) time_dial_V = DEFAULT_TIME_DIAL;
+    if (ioc_pickup_A < 0.0) ioc_pickup_A = DEFAULT_IOC_PICKUP_A;
+    if (ioc_delay_ms < 0)   ioc_delay_ms = DEFAULT_IOC_DELAY_MS;
+    if (fast_pickup_A < 0.0) fast_pickup_A = DEFAULT_FAST_PICKUP_A;
+    if (fast_count < 1 || fast_count > 100) fast_count = DEFAULT_FAST_COUNT;
+    if (uv_pickup_V < 0.0)  uv_pickup_V = DEFAULT_UV_PICKUP_V;
+    if (uv_delay_ms < 0)    uv_delay_ms = DEFAULT_UV_DELAY_MS;
+    if (samples <= 0 || samples > MAX_SAMPLES) samples = DEFAULT_SAMPLES;
     if (sleep_ms < 0 || sleep_ms > 1000) sleep_ms = DEFAULT_SLEEP_MS;
+    if (sample_rate_hz <= 0 || sample_rate_hz > 10000) sample_rate_hz = DEFAULT_SAMPLE_RATE_HZ;
+    if (nominal_freq_hz <= 0.0 || nominal_freq_hz > 1000.0) nominal_freq_hz = DEFAULT_NOMINAL_FREQ_HZ;
+    if (harm_cycles <= 0 || harm_cycles > 100) harm_cycles = DEFAULT_HARM_CYCLES;
+    if (filter_window <= 0 || filter_window > MAX_FILTER_WINDOW) filter_window = DEFAULT_FILTER_WINDOW;
+    if (!(filter_window & 1)) filter_window++;  /* impaire: échantillon central */
+    if (outlier_tol < 0.0)  outlier_tol = DEFAULT_OUTLIER_TOL;
+    if (max_loss_ratio < 0.0 || max_loss_ratio > 1.0) max_loss_ratio = DEFAULT_MAX_LOSS_RATIO;
 
-    if (strcmp(trip_logic, "any") != 0 && strcmp(trip_logic, "both") != 0) {
+    logic_prog_t prog;
+    char err[96];
+    if (logic_compile(&prog, trip_logic, err, sizeof(err)) != 0) {
+        fprintf(stderr, "[WARN] trip_logic \"%s\": %s -> %s.\n", trip_logic, err, DEFAULT_TRIP_LOGIC);
         strncpy(trip_logic, DEFAULT_TRIP_LOGIC, sizeof(trip_logic)-1);
         trip_logic[sizeof(trip_logic)-1] = '\0';
     }
+    if (bom_curve_from_name(curve_A) < 0) {
+        fprintf(stderr, "[WARN] curve_A \"%s\" inconnue -> %s.\n", curve_A, DEFAULT_CURVE);
+        copy_str(curve_A, sizeof(curve_A), DEFAULT_CURVE);
+    }
+    if (bom_curve_from_name(curve_V) < 0) {
+        fprintf(stderr, "[WARN] curve_V \"%s\" inconnue -> %s.\n", curve_V, DEFAULT_CURVE);
+        copy_str(curve_V, sizeof(curve_V), DEFAULT_CURVE);
+    }
+
+    if (strcmp(backend, "hardware") != 0 && strcmp(backend, "synthetic") != 0 &&
+        strcmp(backend, "replay") != 0) {
+        copy_str(backend, sizeof(backend), DEFAULT_BACKEND);
+    }
+    if (!valid_policy(rt_policy))  copy_str(rt_policy, sizeof(rt_policy), DEFAULT_RT_POLICY);
+    if (!valid_policy(nrt_policy)) copy_str(nrt_policy, sizeof(nrt_policy), DEFAULT_NRT_POLICY);
+    if (!valid_policy(acq_policy)) copy_str(acq_policy, sizeof(acq_policy), DEFAULT_ACQ_POLICY);
+    if (rt_priority < 0 || rt_priority > 99)   rt_priority = DEFAULT_RT_PRIORITY;
+    if (nrt_priority < 0 || nrt_priority > 99) nrt_priority = DEFAULT_NRT_PRIORITY;
+    if (acq_priority < 0 || acq_priority > 99) acq_priority = DEFAULT_ACQ_PRIORITY;
+    if (rt_cpu < -1)  rt_cpu = DEFAULT_RT_CPU;
+    if (nrt_cpu < -1) nrt_cpu = DEFAULT_NRT_CPU;
+    if (acq_cpu < -1) acq_cpu = DEFAULT_ACQ_CPU;
+    if (synth_freq_hz <= 0.0)   synth_freq_hz   = DEFAULT_SYNTH_FREQ_HZ;
+    if (synth_current_A < 0.0)  synth_current_A = DEFAULT_SYNTH_CURRENT_A;
+    if (synth_voltage_V < 0.0)  synth_voltage_V = DEFAULT_SYNTH_VOLTAGE_V;
+    if (synth_noise_pct < 0.0)  synth_noise_pct = 0.0;
+    if (synth_fault_gain < 0.0) synth_fault_gain = 1.0;
+    if (synth_fault_ch >= CONFIG_MAX_CHANNELS) synth_fault_ch = -1;
+
+    if (channels <= 0 || channels > CONFIG_MAX_CHANNELS) channels = DEFAULT_CHANNELS;
 }
 
 /* =======================
@@ -77,11 +198,16 @@ int config_load(const char *path) {
                 path, strerror(errno));
         /* on garde les valeurs par défaut */
         clamp_all();
+        atomic_fetch_add(&config_gen, 1);
         return -1;
     }
 
     char line[512];
 
+    /* Tables de calibration: une clé retirée du fichier revient au défaut
+     * (linéaire), comme au démarrage */
+    memset(calib_A, 0, sizeof(calib_A));
+    memset(calib_V, 0, sizeof(calib_V));
 
     while (fgets(line, sizeof(line), f)) {
         char *key = strtok(line, ":");
@@ -95,6 +221,16 @@ int config_load(const char *path) {
         if (strstr(key, "threshold_V")) { thr_V = atof(val); printf("[INFO] thr_V =%.2f\n",thr_V) ; continue; }
         if (strstr(key, "tms_A_ms"))    { tms_A = atoi(val); continue; }
         if (strstr(key, "tms_V_ms"))    { tms_V = atoi(val); continue; }
+        if (strstr(key, "curve_A"))     { copy_str(curve_A, sizeof(curve_A), unquote(val)); continue; }
+        if (strstr(key, "curve_V"))     { copy_str(curve_V, sizeof(curve_V), unquote(val)); continue; }
+        if (strstr(key, "time_dial_A")) { time_dial_A = atof(val); continue; }
+        if (strstr(key, "time_dial_V")) { time_dial_V = atof(val); continue; }
+        if (strstr(key, "ioc_pickup_A")) { ioc_pickup_A = atof(val); continue; }
+        if (strstr(key, "ioc_delay_ms")) { ioc_delay_ms = atoi(val); continue; }
+        if (strstr(key, "fast_pickup_A")) { fast_pickup_A = atof(val); continue; }
+        if (strstr(key, "fast_count"))   { fast_count = atoi(val); continue; }
+        if (strstr(key, "uv_pickup_V"))  { uv_pickup_V = atof(val); continue; }
+        if (strstr(key, "uv_delay_ms"))  { uv_delay_ms = atoi(val); continue; }
         if (strstr(key, "trip_logic"))  {
             val = unquote(val);
             strncpy(trip_logic, val, sizeof(trip_logic)-1);
@@ -102,7 +238,55 @@ int config_load(const char *path) {
             continue;
         }
 
+        /* ---- Backend d'acquisition ---- */
+        if (strstr(key, "backend"))     { copy_str(backend, sizeof(backend), unquote(val)); continue; }
+        if (strstr(key, "replay_file")) { copy_str(replay_file, sizeof(replay_file), unquote(val)); continue; }
+        if (strstr(key, "capture_file")) { copy_str(capture_file, sizeof(capture_file), unquote(val)); continue; }
+        if (strstr(key, "replay_loop")) { replay_loop = atoi(val); continue; }
+        if (strstr(key, "synth_freq_hz"))     { synth_freq_hz = atof(val); continue; }
+        if (strstr(key, "synth_current_A"))   { synth_current_A = atof(val); continue; }
+        if (strstr(key, "synth_voltage_V"))   { synth_voltage_V = atof(val); continue; }
+        if (strstr(key, "synth_harm_pct"))    { copy_str(synth_harm_pct, sizeof(synth_harm_pct), unquote(val)); continue; }
+        if (strstr(key, "synth_noise_pct"))   { synth_noise_pct = atof(val); continue; }
+        if (strstr(key, "synth_fault_at_ms")) { synth_fault_at_ms = atoi(val); continue; }
+        if (strstr(key, "synth_fault_gain"))  { synth_fault_gain = atof(val); continue; }
+        if (strstr(key, "synth_fault_ch"))    { synth_fault_ch = atoi(val); continue; }
+
+        /* ---- Ordonnancement APS (nrt_* avant rt_*: sous-chaîne) ---- */
+        if (strstr(key, "nrt_policy"))   { copy_str(nrt_policy, sizeof(nrt_policy), unquote(val)); continue; }
+        if (strstr(key, "nrt_priority")) { nrt_priority = atoi(val); continue; }
+        if (strstr(key, "nrt_cpu"))      { nrt_cpu = atoi(val); continue; }
+        if (strstr(key, "rt_policy"))    { copy_str(rt_policy, sizeof(rt_policy), unquote(val)); continue; }
+        if (strstr(key, "rt_priority"))  { rt_priority = atoi(val); continue; }
+        if (strstr(key, "rt_cpu"))       { rt_cpu = atoi(val); continue; }
+        if (strstr(key, "acq_policy"))   { copy_str(acq_policy, sizeof(acq_policy), unquote(val)); continue; }
+        if (strstr(key, "acq_priority")) { acq_priority = atoi(val); continue; }
+        if (strstr(key, "acq_cpu"))      { acq_cpu = atoi(val); continue; }
+
+        /* ---- Multi-départs ---- */
+        if (strstr(key, "channels"))   { channels = atoi(val); continue; }
+        if (strstr(key, "trig_lines")) { copy_str(trig_lines, sizeof(trig_lines), unquote(val)); continue; }
+        if (strstr(key, "echo_lines")) { copy_str(echo_lines, sizeof(echo_lines), unquote(val)); continue; }
+
+        /* ---- Calibration ---- */
+        if (strstr(key, "calib_A")) {
+            int s = calib_slot(key, "calib_A");
+            if (s >= 0) copy_str(calib_A[s], sizeof(calib_A[s]), unquote(val));
+            continue;
+        }
+        if (strstr(key, "calib_V")) {
+            int s = calib_slot(key, "calib_V");
+            if (s >= 0) copy_str(calib_V[s], sizeof(calib_V[s]), unquote(val));
+            continue;
+        }
+
         /* ---- Commun ---- */
+        if (strstr(key, "sample_rate_hz")) { sample_rate_hz = atoi(val); continue; }
+        if (strstr(key, "nominal_freq_hz")) { nominal_freq_hz = atof(val); continue; }
+        if (strstr(key, "harm_cycles"))  { harm_cycles = atoi(val); continue; }
+        if (strstr(key, "filter_window")) { filter_window = atoi(val); continue; }
+        if (strstr(key, "outlier_tol"))  { outlier_tol = atof(val); continue; }
+        if (strstr(key, "max_loss_ratio")) { max_loss_ratio = atof(val); continue; }
         if (strstr(key, "samples")) { samples = atoi(val);  continue; }
         if (strstr(key, "sleep_between_samples_ms")) { sleep_ms = atoi(val);  continue; }
 
@@ -119,12 +303,13 @@ int config_load(const char *path) {
 
     fclose(f);
     clamp_all();
+    atomic_fetch_add(&config_gen, 1);
 
     /* Diagnostic synthèse */
     fprintf(stdout,
         "[INFO] Config chargée: "
-        "thrA=%.3f tmsA=%d thrV=%.3f tmsV=%d smp=%d sleep=%d mode=%s logic=%s\n",
-        thr_A, tms_A, thr_V, tms_V, samples, sleep_ms, mode, trip_logic);
+        "thrA=%.3f tmsA=%d thrV=%.3f tmsV=%d smp=%d sleep=%d rate=%dHz mode=%s logic=%s backend=%s voies=%d\n",
+        thr_A, tms_A, thr_V, tms_V, samples, sleep_ms, sample_rate_hz, mode, trip_logic, backend, channels);
 
     /* Remarque: si seules les clés historiques ont été trouvées, c'est OK (A utilisera ces valeurs). */
 
@@ -140,6 +325,7 @@ int    config_get_tms_ms(void)       { return tms_A; }   /* idem pour TMS géné
 int    config_get_samples(void)      { return samples; }
 int    config_get_sleep_ms(void)     { return sleep_ms; }
 const char* config_get_mode(void)    { return mode; }
+unsigned    config_generation(void)  { return atomic_load(&config_gen); }
 
 /* =======================
  * Getters étendus
@@ -149,4 +335,78 @@ double      config_get_threshold_A(void)  { return thr_A; }
 double      config_get_threshold_V(void)  { return thr_V; }
 int         config_get_tms_A_ms(void)     { return tms_A; }
 int         config_get_tms_V_ms(void)     { return tms_V; }
+const char* config_get_curve_A(void)      { return curve_A; }
+const char* config_get_curve_V(void)      { return curve_V; }
+double      config_get_time_dial_A(void)  { return time_dial_A; }
+double      config_get_time_dial_V(void)  { return time_dial_V; }
+double      config_get_ioc_pickup_A(void) { return ioc_pickup_A; }
+int         config_get_ioc_delay_ms(void) { return ioc_delay_ms; }
+double      config_get_fast_pickup_A(void) { return fast_pickup_A; }
+int         config_get_fast_count(void)   { return fast_count; }
+double      config_get_uv_pickup_V(void)  { return uv_pickup_V; }
+int         config_get_uv_delay_ms(void)  { return uv_delay_ms; }
 const char* config_get_trip_logic(void)   { return trip_logic; }
+int         config_get_sample_rate_hz(void) { return sample_rate_hz; }
+double      config_get_nominal_freq_hz(void) { return nominal_freq_hz; }
+int         config_get_harm_cycles(void)  { return harm_cycles; }
+int         config_get_filter_window(void) { return filter_window; }
+double      config_get_outlier_tol(void)  { return outlier_tol; }
+double      config_get_max_loss_ratio(void) { return max_loss_ratio; }
+
+/* =======================
+ * Getters backend d'acquisition
+ * ======================= */
+
+const char* config_get_backend(void)          { return backend; }
+const char* config_get_rt_policy(void)        { return rt_policy; }
+int         config_get_rt_priority(void)      { return rt_priority; }
+int         config_get_rt_cpu(void)           { return rt_cpu; }
+const char* config_get_nrt_policy(void)       { return nrt_policy; }
+int         config_get_nrt_priority(void)     { return nrt_priority; }
+int         config_get_nrt_cpu(void)          { return nrt_cpu; }
+const char* config_get_acq_policy(void)       { return acq_policy; }
+int         config_get_acq_priority(void)     { return acq_priority; }
+int         config_get_acq_cpu(void)          { return acq_cpu; }
+const char* config_get_replay_file(void)      { return replay_file; }
+const char* config_get_capture_file(void)     { return capture_file; }
+int         config_get_replay_loop(void)      { return replay_loop; }
+double      config_get_synth_freq_hz(void)    { return synth_freq_hz; }
+double      config_get_synth_current_A(void)  { return synth_current_A; }
+double      config_get_synth_voltage_V(void)  { return synth_voltage_V; }
+const char* config_get_synth_harm_pct(void)   { return synth_harm_pct; }
+double      config_get_synth_noise_pct(void)  { return synth_noise_pct; }
+int         config_get_synth_fault_at_ms(void){ return synth_fault_at_ms; }
+double      config_get_synth_fault_gain(void) { return synth_fault_gain; }
+int         config_get_synth_fault_ch(void)   { return synth_fault_ch; }
+
+/* =======================
+ * Getters multi-départs
+ * ======================= */
+
+int         config_get_channels(void)         { return channels; }
+const char* config_get_trig_lines(void)       { return trig_lines; }
+const char* config_get_echo_lines(void)       { return echo_lines; }
+
+/* =======================
+ * Getters calibration
+ * ======================= */
+
+const char* config_get_calib_A(int ch) {
+    return (ch >= 0 && ch < CONFIG_MAX_CHANNELS) ? calib_A[1 + ch] : calib_A[0];
+}
+const char* config_get_calib_V(int ch) {
+    return (ch >= 0 && ch < CONFIG_MAX_CHANNELS) ? calib_V[1 + ch] : calib_V[0];
+}
+
+int config_parse_lines(const char *s, unsigned *lines, int max) {
+    int n = 0;
+    if (!s) return 0;
+    while (*s && n < max) {
+        char *end;
+        long v = strtol(s, &end, 10);
+        if (end == s) { s++; continue; } // séparateur (espace, ';')
+        if (v >= 0) lines[n++] = (unsigned)v;
+        s = end;
+    }
+    return n;
+}
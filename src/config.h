@@ -18,7 +18,56 @@
 #define DEFAULT_THRESHOLD_V  230.0
 #define DEFAULT_TMS_A_MS     DEFAULT_TMS_MS
 #define DEFAULT_TMS_V_MS     2000
-#define DEFAULT_TRIP_LOGIC   "any"       /* "any" | "both" */
+#define DEFAULT_TRIP_LOGIC   "any"       /* "any" | "both" | expression (cf. logic.h) */
+#define TRIP_LOGIC_MAX       128
+#define DEFAULT_CURVE        "definite"  /* "definite" | "iec_si|vi|ei" | "ieee_mi|vi|ei" */
+#define DEFAULT_TIME_DIAL    1.0         /* multiplicateur des courbes à temps inverse */
+#define DEFAULT_IOC_PICKUP_A 0.0         /* 50: maximum de courant instantané (0 = absent) */
+#define DEFAULT_IOC_DELAY_MS 0
+#define DEFAULT_FAST_PICKUP_A 0.0        /* 50 HS instantané, thread d'acquisition (0 = absent) */
+#define DEFAULT_FAST_COUNT    2          /* échantillons consécutifs au-dessus du seuil */
+#define DEFAULT_UV_PICKUP_V  0.0         /* 27: minimum de tension (0 = absent) */
+#define DEFAULT_UV_DELAY_MS  2000
+#define DEFAULT_SAMPLE_RATE_HZ 100       /* cadence du thread d'acquisition */
+#define MAX_SAMPLES          100000      /* fenêtre RMS max (échantillons) */
+#define DEFAULT_NOMINAL_FREQ_HZ 50.0     /* fréquence réseau (analyse harmonique) */
+#define DEFAULT_HARM_CYCLES  5           /* fenêtre Goertzel en périodes réseau */
+#define DEFAULT_FILTER_WINDOW 5          /* médiane glissante anti-aberrants (1 = timeouts seuls) */
+#define MAX_FILTER_WINDOW    31
+#define DEFAULT_OUTLIER_TOL  1.0         /* écart à la médiane toléré, x max(RMS, |médiane|) */
+#define DEFAULT_MAX_LOSS_RATIO 0.2       /* part d'échantillons rejetés au-delà de laquelle la voie est invalide */
+
+/* =======================
+ * Defaults (backend d'acquisition)
+ * ======================= */
+#define DEFAULT_BACKEND      "hardware"  /* "hardware" | "synthetic" | "replay" */
+#define DEFAULT_REPLAY_FILE  "replay.csv"
+#define DEFAULT_CAPTURE_FILE ""          /* vide = pas de capture */
+#define DEFAULT_SYNTH_FREQ_HZ   50.0
+#define DEFAULT_SYNTH_CURRENT_A 560.0
+#define DEFAULT_SYNTH_VOLTAGE_V 240.0
+
+/* =======================
+ * Defaults (ordonnancement APS, cf. scheduler.h)
+ * ======================= */
+#define DEFAULT_RT_POLICY    "fifo"      /* "fifo" | "rr" | "other" */
+#define DEFAULT_RT_PRIORITY  80
+#define DEFAULT_RT_CPU       -1          /* -1 = pas d'épinglage */
+#define DEFAULT_NRT_POLICY   "other"
+#define DEFAULT_NRT_PRIORITY 0
+#define DEFAULT_NRT_CPU      -1
+/* Thread d'acquisition (chemin rapide 50 HS): au-dessus de la classe RT */
+#define DEFAULT_ACQ_POLICY   "fifo"
+#define DEFAULT_ACQ_PRIORITY 90
+#define DEFAULT_ACQ_CPU      -1
+
+/* =======================
+ * Defaults (multi-départs)
+ * ======================= */
+#define CONFIG_MAX_CHANNELS  8           /* = BEA_MAX_CH */
+#define DEFAULT_CHANNELS     1
+#define DEFAULT_TRIG_LINES   "20"        /* offsets TRIG séparés par des espaces */
+#define DEFAULT_ECHO_LINES   "16"        /* offsets ECHO, même ordre que TRIG */
 
 /* =======================
  * API publique
@@ -26,6 +75,8 @@
 
 /* Charge config.json ; retourne 0 si OK, -1 si échec (valeurs par défaut utilisées). */
 int   config_load(const char *path);
+/* Génération de la config: change à chaque config_load (caches des vues dérivées). */
+unsigned config_generation(void);
 
 /* --- Getters "historiques" (compat main/mms existants) --- */
 double      config_get_threshold(void);           /* retourne le seuil courant "générique" (par ex. A) */
@@ -39,4 +90,55 @@ double      config_get_threshold_A(void);
 double      config_get_threshold_V(void);
 int         config_get_tms_A_ms(void);
 int         config_get_tms_V_ms(void);
+const char* config_get_curve_A(void);
+const char* config_get_curve_V(void);
+double      config_get_time_dial_A(void);
+double      config_get_time_dial_V(void);
+double      config_get_ioc_pickup_A(void);
+int         config_get_ioc_delay_ms(void);
+double      config_get_fast_pickup_A(void);
+int         config_get_fast_count(void);
+double      config_get_uv_pickup_V(void);
+int         config_get_uv_delay_ms(void);
 const char* config_get_trip_logic(void);
+int         config_get_sample_rate_hz(void);
+double      config_get_nominal_freq_hz(void);
+int         config_get_harm_cycles(void);
+int         config_get_filter_window(void);
+double      config_get_outlier_tol(void);
+double      config_get_max_loss_ratio(void);
+
+/* --- Backend d'acquisition --- */
+const char* config_get_backend(void);
+const char* config_get_rt_policy(void);
+int         config_get_rt_priority(void);
+int         config_get_rt_cpu(void);
+const char* config_get_nrt_policy(void);
+int         config_get_nrt_priority(void);
+int         config_get_nrt_cpu(void);
+const char* config_get_acq_policy(void);
+int         config_get_acq_priority(void);
+int         config_get_acq_cpu(void);
+const char* config_get_replay_file(void);
+const char* config_get_capture_file(void);
+int         config_get_replay_loop(void);
+double      config_get_synth_freq_hz(void);
+double      config_get_synth_current_A(void);
+double      config_get_synth_voltage_V(void);
+const char* config_get_synth_harm_pct(void);   /* liste "h2 h3 ..." en % */
+double      config_get_synth_noise_pct(void);
+int         config_get_synth_fault_at_ms(void); /* <0 = pas de défaut */
+double      config_get_synth_fault_gain(void);
+int         config_get_synth_fault_ch(void);    /* <0 = toutes les voies */
+
+/* --- Multi-départs --- */
+int         config_get_channels(void);
+const char* config_get_trig_lines(void);       /* liste "20 21 ..." */
+const char* config_get_echo_lines(void);       /* liste "16 17 ..." */
+/* Parse une liste d'offsets GPIO séparés par des espaces. Retourne le nombre lu. */
+int         config_parse_lines(const char *s, unsigned *lines, int max);
+
+/* --- Calibration (tables "pulse_us:valeur ...", cf. calib.h) --- */
+/* ch < 0: table commune ("calib_A"); ch >= 0: surcharge de la voie ("calib_A_<ch>", "" si absente) */
+const char* config_get_calib_A(int ch);
+const char* config_get_calib_V(int ch);
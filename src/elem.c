@@ -0,0 +1,139 @@
+// src/elem.c
+#include "elem.h"
+#include <string.h>
+#include <math.h>
+
+#define ELEM_RESET_RATE 1e9   // temps constant: remise à zéro immédiate au repos
+#define ELEM_MIN_INPUT  1e-9  // plancher des éléments à minimum (entrée nulle)
+#define ELEM_EPS        1e-9  // tolérance de cumul des dt sur theta (10 x 0.1 s = 1 s)
+
+static const char *kind_names[ELEM_KIND_COUNT] = { "50", "51", "27", "59" };
+
+void elem_clear(elem_table_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+static uint32_t elem_key(const elem_table_t *t, int i) {
+    return (uint32_t)t->kind[i] | (uint32_t)t->ch[i] << 8 | (uint32_t)t->src[i] << 16;
+}
+
+void elem_save_state(const elem_table_t *t, elem_state_t *s) {
+    s->n = t->n;
+    for (int i = 0; i < t->n; ++i) {
+        s->key[i]   = elem_key(t, i);
+        s->m[i]     = t->m[i];
+        s->on[i]    = t->on[i];
+        s->theta[i] = t->theta[i];
+    }
+}
+
+void elem_restore_state(elem_table_t *t, const elem_state_t *s) {
+    uint8_t used[ELEM_MAX] = {0};
+    for (int i = 0; i < t->n; ++i) {
+        uint32_t key = elem_key(t, i);
+        for (int j = 0; j < s->n; ++j) {
+            if (used[j] || s->key[j] != key) continue;
+            used[j] = 1;
+            t->m[i]     = s->m[j];
+            t->on[i]    = s->on[j];
+            t->theta[i] = s->theta[j];
+            break;
+        }
+    }
+}
+
+/* Réglages communs; retourne l'index ou -1 */
+static int elem_add(elem_table_t *t, elem_kind_t kind, int ch, int src, double pickup) {
+    if (t->n >= ELEM_MAX || (unsigned)kind >= ELEM_KIND_COUNT ||
+        src < 0 || src >= ELEM_INPUTS || pickup <= 0.0) return -1;
+    int i = t->n++;
+    t->kind[i]       = (uint8_t)kind;
+    t->ch[i]         = (uint8_t)ch;
+    t->src[i]        = (uint8_t)src;
+    t->pickup[i]     = pickup;
+    t->inv_pickup[i] = 1.0 / pickup;
+    t->under[i]      = (kind == ELEM_UV) ? 1.0 : 0.0;
+    t->inst[i]       = 0.0;
+    t->rate_on[i]    = 0.0;
+    t->rate_off[i]   = ELEM_RESET_RATE;
+    t->m[i]          = 0.0;
+    t->on[i]         = 0.0;
+    t->theta[i]      = 0.0;
+    t->trip[i]       = 0;
+    return i;
+}
+
+int elem_add_definite(elem_table_t *t, elem_kind_t kind, int ch, int src, double pickup, int delay_ms) {
+    int i = elem_add(t, kind, ch, src, pickup);
+    if (i < 0) return -1;
+    if (delay_ms <= 0) t->inst[i] = 1.0;
+    else t->rate_on[i] = 1000.0 / (double)delay_ms;
+    return i;
+}
+
+int elem_add_inverse(elem_table_t *t, elem_kind_t kind, int ch, int src, double pickup,
+                     bom_curve_t curve, double td) {
+    double a, b, p, tr;
+    if (curve == BOM_CURVE_DEFINITE || td <= 0.0 || bom_curve_params(curve, &a, &b, &p, &tr) != 0) return -1;
+    int i = elem_add(t, kind, ch, src, pickup);
+    if (i < 0) return -1;
+    t->k_a[i]  = td * a;
+    t->k_b[i]  = td * b;
+    t->k_p[i]  = p;
+    t->k_tr[i] = td * tr;
+    t->inv_idx[t->n_inv++] = (uint16_t)i;
+    return i;
+}
+
+void elem_eval(elem_table_t *t, const double *in, const double *valid, double dt_s) {
+    const int n = t->n;
+    if (dt_s < 0.0) dt_s = 0.0;
+
+    /* Passe 0: entrées du cycle (indirection voie/grandeur) */
+    for (int i = 0; i < n; ++i) {
+        t->x[i]  = in[t->src[i]];
+        t->ok[i] = valid[t->src[i]];
+    }
+
+    /* Passe 1: M = valeur/seuil (maximum) ou seuil/valeur (minimum), plafonné;
+     * entrée invalide: M du dernier cycle valide conservé */
+    for (int i = 0; i < n; ++i) {
+        double x  = t->x[i];
+        double mo = x * t->inv_pickup[i];
+        double mu = t->pickup[i] / (x > ELEM_MIN_INPUT ? x : ELEM_MIN_INPUT);
+        double m  = (t->under[i] > 0.0) ? mu : mo;
+        m = (m < BOM_M_MAX) ? m : BOM_M_MAX;
+        t->m[i] = (t->ok[i] > 0.0) ? m : t->m[i];
+    }
+
+    /* Passe 2: vitesses des éléments à temps inverse (seuls à dépendre de M) */
+    for (int k = 0; k < t->n_inv; ++k) {
+        int i = t->inv_idx[k];
+        double m = t->m[i];
+        if (m > 1.0) t->rate_on[i]  = 1.0 / (t->k_a[i] / (pow(m, t->k_p[i]) - 1.0) + t->k_b[i]);
+        else         t->rate_off[i] = (1.0 - m * m) / t->k_tr[i];
+    }
+
+    /* Passe 3: intégration de theta. La temporisation part du premier cycle
+     * sollicité (sollicité au cycle précédent ET à celui-ci), le retour
+     * s'applique dès le premier cycle au repos. */
+    for (int i = 0; i < n; ++i) {
+        double on = (t->m[i] > 1.0) ? 1.0 : 0.0;
+        double up = on * t->on[i];
+        double th = t->theta[i] + dt_s * (up * t->rate_on[i] - (1.0 - on) * t->rate_off[i]);
+        th = (th < 0.0) ? 0.0 : th;
+        th = (th > 1.0) ? 1.0 : th;
+        th = (on * t->inst[i] > th) ? 1.0 : th;
+        // ok vaut 0 ou 1: sélection arithmétique exacte
+        double ok = t->ok[i];
+        t->theta[i] = ok * th + (1.0 - ok) * t->theta[i];
+        t->on[i]    = ok * on + (1.0 - ok) * t->on[i];
+    }
+    for (int i = 0; i < n; ++i) {
+        t->trip[i] = (uint8_t)((t->ok[i] > 0.0) & (t->theta[i] >= 1.0 - ELEM_EPS));
+    }
+}
+
+const char* elem_kind_name(elem_kind_t kind) {
+    return ((unsigned)kind < ELEM_KIND_COUNT) ? kind_names[kind] : "?";
+}
@@ -0,0 +1,102 @@
+// src/elem.h
+#pragma once
+#include <stdint.h>
+#include "bom.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * ELEM: table d'éléments de protection (maximum de courant instantané et
+ * temporisé, minimum et maximum de tension), rangée en tableaux par champ
+ * (seuils, constantes, états) et évaluée en une passe par cycle avec un
+ * seul instant pour toute la table.
+ *
+ * Chaque élément compare une grandeur d'entrée (RMS courant ou tension d'une
+ * voie) à son seuil via M = valeur/seuil (maximum) ou seuil/valeur (minimum):
+ * M > 1 = élément sollicité. Progression theta (0..1, 1 = déclenchement, à
+ * une tolérance près: theta est une somme de dt flottants):
+ * - temps constant: theta += dt/délai en sollicitation (à partir du premier
+ *   cycle sollicité), remise à zéro sinon; délai nul = instantané;
+ * - temps inverse (courbes bom): theta += dt/t(M), décroissance dt/r(M).
+ * Passes 1 et 3 (M, intégration) sans branche, vectorisables; seuls les
+ * éléments à temps inverse (indexés au chargement) passent par pow().
+ * Une entrée invalide gèle la progression de ses éléments (pas de décision).
+ */
+
+#define ELEM_MAX     256   // éléments par table
+#define ELEM_INPUTS  16    // entrées: 8 voies x {courant, tension}
+#define ELEM_SRC_A(ch) (ch)                     // entrée courant de la voie
+#define ELEM_SRC_V(ch) (ELEM_INPUTS / 2 + (ch)) // entrée tension de la voie
+
+typedef enum {
+    ELEM_IOC = 0,   // 50: maximum de courant instantané
+    ELEM_TOC,       // 51: maximum de courant temporisé
+    ELEM_UV,        // 27: minimum de tension
+    ELEM_OV,        // 59: maximum de tension
+    ELEM_KIND_COUNT
+} elem_kind_t;
+
+typedef struct {
+    int      n;
+    /* Réglages (figés au chargement) */
+    uint8_t  kind[ELEM_MAX];
+    uint8_t  ch[ELEM_MAX];
+    uint8_t  src[ELEM_MAX];        // index d'entrée (voie, grandeur)
+    double   pickup[ELEM_MAX];     // seuil
+    double   inv_pickup[ELEM_MAX]; // 1/seuil
+    double   under[ELEM_MAX];      // 1 = élément à minimum, 0 = à maximum
+    double   inst[ELEM_MAX];       // 1 = instantané
+    double   rate_on[ELEM_MAX];    // progression par seconde en sollicitation
+    double   rate_off[ELEM_MAX];   // décroissance par seconde au repos
+    /* Temps inverse */
+    int      n_inv;
+    uint16_t inv_idx[ELEM_MAX];
+    double   k_a[ELEM_MAX], k_b[ELEM_MAX], k_p[ELEM_MAX], k_tr[ELEM_MAX];
+    /* État */
+    double   x[ELEM_MAX];          // grandeur d'entrée du dernier cycle
+    double   ok[ELEM_MAX];         // 1 = entrée valide
+    double   m[ELEM_MAX];          // M du dernier cycle valide
+    double   on[ELEM_MAX];         // 1 = sollicité au dernier cycle valide
+    double   theta[ELEM_MAX];
+    uint8_t  trip[ELEM_MAX];
+} elem_table_t;
+
+/** États à reprendre d'une table à la suivante (rechargement de config). */
+typedef struct {
+    int      n;
+    uint32_t key[ELEM_MAX];        // type | voie << 8 | entrée << 16
+    double   m[ELEM_MAX];
+    double   on[ELEM_MAX];
+    double   theta[ELEM_MAX];
+} elem_state_t;
+
+/** Vide la table. */
+void elem_clear(elem_table_t *t);
+/** Copie les états (M, sollicitation, theta) de la table. */
+void elem_save_state(const elem_table_t *t, elem_state_t *s);
+/**
+ * Reprend les états sauvegardés pour les éléments de même type, voie et
+ * entrée (réglages modifiés ou non); les nouveaux éléments partent de zéro.
+ */
+void elem_restore_state(elem_table_t *t, const elem_state_t *s);
+/**
+ * Ajoute un élément à temps constant (delay_ms = 0: instantané) sur l'entrée
+ * src (ELEM_SRC_A/ELEM_SRC_V). Retourne son index, -1 si table pleine ou seuil <= 0.
+ */
+int  elem_add_definite(elem_table_t *t, elem_kind_t kind, int ch, int src, double pickup, int delay_ms);
+/** Ajoute un élément à temps inverse (courbe bom, td = multiplicateur). Retourne son index ou -1. */
+int  elem_add_inverse(elem_table_t *t, elem_kind_t kind, int ch, int src, double pickup,
+                      bom_curve_t curve, double td);
+/**
+ * Évalue toute la table: in[src] = grandeurs du cycle, valid[src] = 0/1,
+ * dt_s = temps écoulé depuis l'évaluation précédente.
+ */
+void elem_eval(elem_table_t *t, const double *in, const double *valid, double dt_s);
+/** Code ANSI de l'élément ("50", "51", "27", "59"). */
+const char* elem_kind_name(elem_kind_t kind);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,136 @@
+// src/evl.c
+#include "evl.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+static void evl_on_wake(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    evl_t *l = (evl_t*)ctx;
+    uint64_t v;
+    while (read(fd, &v, sizeof(v)) < 0 && errno == EINTR) { }
+    atomic_store_explicit(&l->running, 0, memory_order_relaxed);
+}
+
+int evl_init(evl_t *l) {
+    memset(l, 0, sizeof(*l));
+    for (int i = 0; i < EVL_MAX_SOURCES; ++i) l->src[i].fd = -1;
+    l->wake_fd = -1;
+    l->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (l->epfd < 0) {
+        fprintf(stderr, "[ERROR] epoll_create1: %s\n", strerror(errno));
+        return -1;
+    }
+    l->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (l->wake_fd < 0 || evl_add(l, l->wake_fd, EPOLLIN, evl_on_wake, l) != 0) {
+        fprintf(stderr, "[ERROR] eventfd(evl): %s\n", strerror(errno));
+        evl_close(l);
+        return -1;
+    }
+    atomic_store(&l->running, 1);
+    return 0;
+}
+
+void evl_close(evl_t *l) {
+    if (l->wake_fd >= 0) close(l->wake_fd);
+    if (l->epfd >= 0) close(l->epfd);
+    l->wake_fd = l->epfd = -1;
+}
+
+/* Donnée epoll d'un emplacement: index (32 bits bas) et génération (32 bits hauts) */
+static uint64_t evl_tag(const evl_t *l, int i) {
+    return (uint64_t)(uint32_t)i | (uint64_t)l->src[i].gen << 32;
+}
+
+int evl_add(evl_t *l, int fd, uint32_t events, evl_fn_t fn, void *ctx) {
+    if (l->epfd < 0 || fd < 0 || !fn) return -1;
+    int i = 0;
+    while (i < EVL_MAX_SOURCES && l->src[i].fd >= 0) i++;
+    if (i == EVL_MAX_SOURCES) return -1;
+    uint32_t gen = l->src[i].gen + 1;
+    l->src[i].gen = gen;
+    struct epoll_event ev = { .events = events, .data.u64 = evl_tag(l, i) };
+    if (epoll_ctl(l->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) return -1;
+    l->src[i] = (evl_source_t){ fd, fn, ctx, gen };
+    return 0;
+}
+
+static int evl_find(const evl_t *l, int fd) {
+    for (int i = 0; i < EVL_MAX_SOURCES; ++i) {
+        if (l->src[i].fd == fd) return i;
+    }
+    return -1;
+}
+
+int evl_mod(evl_t *l, int fd, uint32_t events) {
+    int i = evl_find(l, fd);
+    if (i < 0) return -1;
+    struct epoll_event ev = { .events = events, .data.u64 = evl_tag(l, i) };
+    return epoll_ctl(l->epfd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+int evl_del(evl_t *l, int fd) {
+    int i = evl_find(l, fd);
+    if (i < 0) return -1;
+    epoll_ctl(l->epfd, EPOLL_CTL_DEL, fd, NULL);
+    l->src[i].fd = -1; // emplacement libre; sa génération écarte les événements déjà rendus
+    return 0;
+}
+
+int evl_run(evl_t *l) {
+    struct epoll_event evs[EVL_MAX_EVENTS];
+    while (atomic_load_explicit(&l->running, memory_order_relaxed)) {
+        int n = epoll_wait(l->epfd, evs, EVL_MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "[ERROR] epoll_wait: %s\n", strerror(errno));
+            return -1;
+        }
+        l->wakeups++;
+        for (int i = 0; i < n; ++i) {
+            uint64_t tag = evs[i].data.u64;
+            evl_source_t *s = &l->src[(uint32_t)tag % EVL_MAX_SOURCES];
+            // retirée (et peut-être réoccupée) par un callback précédent du même réveil
+            if (s->fd < 0 || s->gen != (uint32_t)(tag >> 32)) continue;
+            s->fn(s->fd, evs[i].events, s->ctx);
+        }
+    }
+    return 0;
+}
+
+void evl_stop(evl_t *l) {
+    uint64_t one = 1;
+    if (l->wake_fd >= 0) {
+        ssize_t w = write(l->wake_fd, &one, sizeof(one));
+        (void)w;
+    }
+}
+
+/* -------------------- timerfd -------------------- */
+
+int evl_timer_create(void) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) fprintf(stderr, "[ERROR] timerfd_create: %s\n", strerror(errno));
+    return tfd;
+}
+
+int evl_timer_arm_abs(int tfd, int64_t abs_ns) {
+    if (abs_ns <= 0) abs_ns = 1; // 0 désarmerait le timer: échéance immédiate
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec  = (time_t)(abs_ns / 1000000000LL);
+    its.it_value.tv_nsec = (long)(abs_ns % 1000000000LL);
+    return timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+uint64_t evl_timer_ack(int tfd) {
+    uint64_t n = 0;
+    while (read(tfd, &n, sizeof(n)) < 0) {
+        if (errno != EINTR) return 0; // EAGAIN: pas encore expiré
+    }
+    return n;
+}
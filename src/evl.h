@@ -0,0 +1,68 @@
+// src/evl.h
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * EVL: boucle d'événements (réacteur) sur epoll, un thread par boucle.
+ * Sources: descripteurs quelconques (sockets HTTP, événements de ligne
+ * gpiod, timerfd des tâches APS) avec un callback chacune. Le thread ne se
+ * réveille que sur un événement: pas de sommeil périodique ni de timeout
+ * de select. evl_stop() (tout thread) réveille la boucle par un eventfd.
+ *
+ * Les callbacks s'exécutent dans le thread de la boucle, dans l'ordre des
+ * événements rendus par epoll_wait; une source peut être retirée depuis
+ * son propre callback. Chaque événement porte l'emplacement et sa
+ * génération: un événement déjà rendu pour une source retirée n'est pas
+ * délivré, même si l'emplacement a été réoccupé dans le même réveil.
+ */
+
+#define EVL_MAX_SOURCES 64
+#define EVL_MAX_EVENTS  16   // événements traités par réveil
+
+typedef void (*evl_fn_t)(int fd, uint32_t events, void *ctx);
+
+typedef struct {
+    int      fd;             // -1 = emplacement libre
+    evl_fn_t fn;
+    void    *ctx;
+    uint32_t gen;            // incrémenté à chaque occupation de l'emplacement
+} evl_source_t;
+
+typedef struct {
+    int          epfd;
+    int          wake_fd;    // eventfd d'arrêt
+    _Atomic int  running;
+    evl_source_t src[EVL_MAX_SOURCES];
+    uint64_t     wakeups;    // réveils de epoll_wait (thread de la boucle)
+} evl_t;
+
+/** Crée la boucle (epoll + eventfd d'arrêt). Retourne 0 si OK. */
+int  evl_init(evl_t *l);
+/** Ferme la boucle (après evl_run). */
+void evl_close(evl_t *l);
+/** Ajoute une source (events = EPOLLIN...). Retourne 0 si OK, -1 si pleine ou erreur. */
+int  evl_add(evl_t *l, int fd, uint32_t events, evl_fn_t fn, void *ctx);
+/** Change les événements attendus d'une source. */
+int  evl_mod(evl_t *l, int fd, uint32_t events);
+/** Retire une source (le descripteur n'est pas fermé). */
+int  evl_del(evl_t *l, int fd);
+/** Boucle bloquante jusqu'à evl_stop(). Retourne 0, -1 sur erreur epoll. */
+int  evl_run(evl_t *l);
+/** Demande l'arrêt de la boucle (tout thread, async-signal-safe). */
+void evl_stop(evl_t *l);
+
+/** timerfd CLOCK_MONOTONIC non bloquant. Retourne le descripteur ou -1. */
+int      evl_timer_create(void);
+/** Arme le timer à l'instant absolu abs_ns (CLOCK_MONOTONIC), un coup. */
+int      evl_timer_arm_abs(int tfd, int64_t abs_ns);
+/** Acquitte le timer: nombre d'expirations depuis le dernier acquittement. */
+uint64_t evl_timer_ack(int tfd);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+// src/fast.c
+#include "fast.h"
+#include <string.h>
+#include <math.h>
+
+void fast_init(fast_t *f) {
+    memset(f, 0, sizeof(*f));
+    atomic_store(&f->pickup, 0.0);
+    atomic_store(&f->count, 1);
+    atomic_store(&f->hold, 1);
+    atomic_store(&f->active, 0);
+    atomic_store(&f->trips, 0);
+}
+
+void fast_configure(fast_t *f, double pickup_A, int count, int fs_hz, double f0_hz) {
+    int hold = (f0_hz > 0.0) ? (int)((double)fs_hz / f0_hz + 0.5) : fs_hz;
+    atomic_store_explicit(&f->count, count < 1 ? 1 : count, memory_order_relaxed);
+    atomic_store_explicit(&f->hold, hold < 1 ? 1 : hold, memory_order_relaxed);
+    atomic_store_explicit(&f->pickup, pickup_A > 0.0 ? pickup_A : 0.0, memory_order_release);
+}
+
+int fast_push(fast_t *f, const bea_block_t *blk, double *peak_out) {
+    double pk = atomic_load_explicit(&f->pickup, memory_order_acquire);
+    if (pk <= 0.0) {
+        atomic_store_explicit(&f->active, 0, memory_order_release);
+        return 0;
+    }
+    int count = atomic_load_explicit(&f->count, memory_order_relaxed);
+
+    double peak = 0.0;
+    int fire = 0;
+    for (int c = 0; c < blk->nch && c < BEA_MAX_CH; ++c) {
+        double x = fabs(blk->current_A[c]);
+        if (blk->status[c] >= 0 && x > pk) {
+            if (++f->run[c] >= count) {
+                fire = 1;
+                if (x > peak) peak = x;
+            }
+        } else {
+            f->run[c] = 0;
+        }
+    }
+
+    int active = atomic_load_explicit(&f->active, memory_order_relaxed);
+    if (fire) {
+        f->quiet = 0;
+        if (active) return 0;
+        atomic_store_explicit(&f->active, 1, memory_order_release);
+        atomic_fetch_add_explicit(&f->trips, 1, memory_order_relaxed);
+        if (peak_out) *peak_out = peak;
+        return 1;
+    }
+    if (active && ++f->quiet >= atomic_load_explicit(&f->hold, memory_order_relaxed)) {
+        atomic_store_explicit(&f->active, 0, memory_order_release);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// src/fast.h
+#pragma once
+#include <stdint.h>
+#include <stdatomic.h>
+#include "bea.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * FAST: élément à maximum de courant instantané à seuil haut (50 HS),
+ * évalué sur chaque échantillon dans le thread d'acquisition, hors cycle
+ * APS: défaut franc -> sortie de déclenchement en une période
+ * d'échantillonnage au lieu de 100 ms + fenêtre RMS.
+ *
+ * Critère: |i| > fast_pickup_A (valeur instantanée, A crête) sur fast_count
+ * échantillons consécutifs valides d'une même voie (un pic isolé ne
+ * déclenche pas; pas de filtre médian sur ce chemin). L'élément reste
+ * actif tant que le critère se répète, et retombe après une période réseau
+ * sans dépassement; task_protection maintient alors la sortie tant qu'il
+ * est actif. Réglages relus sans verrou par le thread d'acquisition.
+ */
+
+typedef struct {
+    _Atomic double pickup;        // seuil instantané (A), 0 = élément désactivé
+    _Atomic int    count;         // dépassements consécutifs requis
+    _Atomic int    hold;          // échantillons sans déclenchement avant retombée
+    int            run[BEA_MAX_CH];  // dépassements consécutifs (thread d'acquisition)
+    int            quiet;            // échantillons depuis le dernier déclenchement
+    _Atomic int      active;
+    _Atomic uint64_t trips;       // fronts de déclenchement
+} fast_t;
+
+/** État initial (désactivé). */
+void fast_init(fast_t *f);
+/**
+ * Réglages: pickup_A = seuil instantané (0 = désactivé), count = échantillons
+ * consécutifs, retombée après fs_hz / f0_hz échantillons.
+ */
+void fast_configure(fast_t *f, double pickup_A, int count, int fs_hz, double f0_hz);
+/**
+ * Évalue un échantillon (thread d'acquisition seul). Retourne 1 sur un front
+ * de déclenchement (peak = plus forte valeur |i| des voies en cause), 0 sinon.
+ */
+int  fast_push(fast_t *f, const bea_block_t *blk, double *peak);
+/** Élément actif (déclenché, pas encore retombé). */
+static inline int fast_active(fast_t *f) {
+    return atomic_load_explicit(&f->active, memory_order_acquire);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,64 @@
+// src/harm.c
+#include "harm.h"
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#ifndef M_SQRT2
+#define M_SQRT2 1.41421356237309504880
+#endif
+
+int harm_init(harm_bank_t *h, double fs_hz, double f0_hz, int cycles) {
+    if (!h || fs_hz <= 0.0 || f0_hz <= 0.0 || cycles <= 0) return -1;
+    memset(h, 0, sizeof(*h));
+
+    h->n_win = (int)lround((double)cycles * fs_hz / f0_hz);
+    if (h->n_win < 2) return -1;
+
+    for (int k = 0; k < HARM_MAX; ++k) {
+        double f = (double)(k + 1) * f0_hz;
+        if (f >= fs_hz / 2.0) break;  // au-delà de Nyquist
+        h->coeff[k] = 2.0 * cos(2.0 * M_PI * f / fs_hz);
+        h->nh = k + 1;
+    }
+    return h->nh > 0 ? 0 : -1;
+}
+
+void harm_restart(harm_bank_t *h) {
+    memset(h->s1, 0, sizeof(h->s1));
+    memset(h->s2, 0, sizeof(h->s2));
+    h->count = 0;
+}
+
+/* Fin de fenêtre: |X|² = s1² + s2² - coeff*s1*s2, amplitude crête = 2|X|/N. */
+static void harm_finish(harm_bank_t *h) {
+    harm_result_t *r = &h->last;
+    const double k = M_SQRT2 / (double)h->n_win;  // 2/N (crête) / sqrt(2) (RMS)
+    double sum_h = 0.0;
+
+    for (int i = 0; i < h->nh; ++i) {
+        double p = h->s1[i] * h->s1[i] + h->s2[i] * h->s2[i] - h->coeff[i] * h->s1[i] * h->s2[i];
+        r->mag[i] = (p > 0.0) ? k * sqrt(p) : 0.0;
+        if (i > 0) sum_h += r->mag[i] * r->mag[i];
+        h->s1[i] = h->s2[i] = 0.0;
+    }
+    for (int i = h->nh; i < HARM_MAX; ++i) r->mag[i] = 0.0;
+    r->thd   = (r->mag[0] > 0.0) ? sqrt(sum_h) / r->mag[0] : 0.0;
+    r->nh    = h->nh;
+    r->valid = 1;
+    h->count = 0;
+}
+
+int harm_push(harm_bank_t *h, double x) {
+    if (h->nh == 0) return 0; // banc désactivé (cadence trop basse)
+    for (int i = 0; i < h->nh; ++i) {
+        double s = x + h->coeff[i] * h->s1[i] - h->s2[i];
+        h->s2[i] = h->s1[i];
+        h->s1[i] = s;
+    }
+    if (++h->count < h->n_win) return 0;
+    harm_finish(h);
+    return 1;
+}
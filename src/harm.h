@@ -0,0 +1,52 @@
+// src/harm.h
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * HARM: banc de filtres de Goertzel, fondamental -> rang HARM_MAX, mis à
+ * jour à chaque échantillon (1 multiplication + 2 additions par rang),
+ * sans FFT par fenêtre.
+ *
+ * - Fenêtre = 'cycles' périodes du fondamental (N = cycles * fs / f0
+ *   arrondi): les rangs tombent sur des raies exactes quand fs/f0 est entier.
+ * - En fin de fenêtre: amplitudes RMS par rang + THD, puis remise à zéro
+ *   (fenêtres successives sans recouvrement).
+ * - Rangs au-delà de Nyquist (h*f0 >= fs/2) non calculés (amplitude 0):
+ *   à 1 kHz et 50 Hz, rangs 1..9 seulement.
+ */
+
+#define HARM_MAX 13   // fondamental + 12 harmoniques
+
+typedef struct {
+    double mag[HARM_MAX];  // amplitude RMS du rang h+1 (mag[0] = fondamental)
+    double thd;            // sqrt(Σ mag[h>=1]²) / mag[0] (0 si fondamental nul)
+    int    nh;             // rangs valides (<= HARM_MAX)
+    int    valid;          // 0 tant qu'aucune fenêtre complète
+} harm_result_t;
+
+typedef struct {
+    int    n_win;              // échantillons par fenêtre
+    int    nh;                 // rangs calculés
+    double coeff[HARM_MAX];    // 2cos(2π h f0 / fs)
+    double s1[HARM_MAX];       // états Goertzel s[n-1]
+    double s2[HARM_MAX];       // états Goertzel s[n-2]
+    int    count;              // échantillons dans la fenêtre courante
+    harm_result_t last;        // résultat de la dernière fenêtre complète
+} harm_bank_t;
+
+/**
+ * Prépare le banc (fs = cadence d'échantillonnage, f0 = fréquence réseau).
+ * Retourne 0 si OK, -1 si aucun rang calculable (banc désactivé: harm_push sans effet).
+ */
+int  harm_init(harm_bank_t *h, double fs_hz, double f0_hz, int cycles);
+/** Redémarre la fenêtre courante (trou d'échantillonnage); garde le dernier résultat. */
+void harm_restart(harm_bank_t *h);
+/** Ajoute un échantillon; retourne 1 si une fenêtre vient d'être terminée. */
+int  harm_push(harm_bank_t *h, double x);
+
+#ifdef __cplusplus
+}
+#endif
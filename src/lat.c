@@ -0,0 +1,108 @@
+// src/lat.c
+#include "lat.h"
+#include <stdio.h>
+#include <stdatomic.h>
+
+#define LAT_SUB_BITS 2                        // 4 classes par octave
+#define LAT_SUB      (1 << LAT_SUB_BITS)
+#define LAT_BUCKETS  (64 * LAT_SUB)
+
+typedef struct {
+    _Atomic uint64_t bucket[LAT_BUCKETS];
+    _Atomic uint64_t sum_ns;
+    _Atomic uint64_t max_ns;
+} lat_hist_t;
+
+static lat_hist_t hists[LAT_COUNT];
+
+static const char *stage_names[LAT_COUNT] = {
+    "acq", "queue", "rms", "decision", "gpio", "mms", "e2e_gpio", "e2e_mms",
+    "fast_gpio", "fast_mms"
+};
+
+/* Classe: valeurs < 4 exactes, puis 4 classes par octave */
+static inline int lat_bucket(uint64_t ns) {
+    if (ns < LAT_SUB) return (int)ns;
+    int e = 63 - __builtin_clzll(ns);
+    int sub = (int)(ns >> (e - LAT_SUB_BITS)) & (LAT_SUB - 1);
+    return ((e - LAT_SUB_BITS + 1) << LAT_SUB_BITS) + sub;
+}
+
+/* Borne haute (incluse) d'une classe */
+static uint64_t lat_bucket_upper(int b) {
+    if (b < LAT_SUB) return (uint64_t)b;
+    int e = (b >> LAT_SUB_BITS) + LAT_SUB_BITS - 1;
+    uint64_t sub = (uint64_t)(b & (LAT_SUB - 1));
+    uint64_t width = 1ULL << (e - LAT_SUB_BITS);
+    return ((LAT_SUB + sub) << (e - LAT_SUB_BITS)) + width - 1;
+}
+
+void lat_record(lat_stage_t stage, int64_t ns) {
+    if ((unsigned)stage >= LAT_COUNT) return;
+    lat_hist_t *h = &hists[stage];
+    uint64_t v = (ns > 0) ? (uint64_t)ns : 0;
+    atomic_fetch_add_explicit(&h->bucket[lat_bucket(v)], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum_ns, v, memory_order_relaxed);
+    uint64_t m = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    while (v > m && !atomic_compare_exchange_weak_explicit(&h->max_ns, &m, v,
+                                                           memory_order_relaxed, memory_order_relaxed)) { }
+}
+
+/* Plus petite borne haute couvrant la fraction q des mesures */
+static uint64_t lat_quantile(const uint64_t *snap, uint64_t total, double q) {
+    uint64_t rank = (uint64_t)(q * (double)total + 0.5);
+    if (rank == 0) rank = 1;
+    uint64_t acc = 0;
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        acc += snap[b];
+        if (acc >= rank) return lat_bucket_upper(b);
+    }
+    return lat_bucket_upper(LAT_BUCKETS - 1);
+}
+
+void lat_summary(lat_stage_t stage, lat_summary_t *out) {
+    *out = (lat_summary_t){0};
+    if ((unsigned)stage >= LAT_COUNT) return;
+    lat_hist_t *h = &hists[stage];
+    uint64_t snap[LAT_BUCKETS], total = 0;
+    for (int b = 0; b < LAT_BUCKETS; ++b) {
+        snap[b] = atomic_load_explicit(&h->bucket[b], memory_order_relaxed);
+        total += snap[b];
+    }
+    if (total == 0) return;
+    out->count   = total;
+    out->max_ns  = atomic_load_explicit(&h->max_ns, memory_order_relaxed);
+    out->mean_ns = (double)atomic_load_explicit(&h->sum_ns, memory_order_relaxed) / (double)total;
+    out->p50_ns  = lat_quantile(snap, total, 0.50);
+    out->p99_ns  = lat_quantile(snap, total, 0.99);
+    if (out->p50_ns > out->max_ns) out->p50_ns = out->max_ns;
+    if (out->p99_ns > out->max_ns) out->p99_ns = out->max_ns;
+}
+
+void lat_reset(void) {
+    for (int s = 0; s < LAT_COUNT; ++s) {
+        lat_hist_t *h = &hists[s];
+        for (int b = 0; b < LAT_BUCKETS; ++b) atomic_store_explicit(&h->bucket[b], 0, memory_order_relaxed);
+        atomic_store_explicit(&h->sum_ns, 0, memory_order_relaxed);
+        atomic_store_explicit(&h->max_ns, 0, memory_order_relaxed);
+    }
+}
+
+const char* lat_stage_name(lat_stage_t stage) {
+    return ((unsigned)stage < LAT_COUNT) ? stage_names[stage] : "?";
+}
+
+int lat_build_json(char *buf, size_t sz) {
+    int n = snprintf(buf, sz, "{\n  \"unit\": \"us\",\n  \"stages\": [\n");
+    for (int s = 0; s < LAT_COUNT && n > 0 && (size_t)n < sz; ++s) {
+        lat_summary_t r;
+        lat_summary((lat_stage_t)s, &r);
+        n += snprintf(buf + n, sz - (size_t)n,
+                      "    {\"name\":\"%s\",\"count\":%llu,\"p50\":%.1f,\"p99\":%.1f,\"max\":%.1f,\"mean\":%.1f}%s\n",
+                      stage_names[s], (unsigned long long)r.count,
+                      (double)r.p50_ns / 1e3, (double)r.p99_ns / 1e3, (double)r.max_ns / 1e3,
+                      r.mean_ns / 1e3, (s == LAT_COUNT - 1) ? "" : ",");
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "  ]\n}\n");
+    return n;
+}
@@ -0,0 +1,78 @@
+// src/lat.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LAT: latences de la chaîne de déclenchement, par étage, agrégées dans des
+ * histogrammes à classes fixes (4 classes par octave de ns, résolution
+ * ~19 %), sans verrou: compteurs atomiques relâchés, un écrivain par étage,
+ * lecture concurrente par le serveur HTTP (GET /latency).
+ *
+ * Étages (CLOCK_MONOTONIC):
+ *   ACQ       mesure capteur (impulsion TRIG -> bloc lu), thread d'acquisition
+ *   QUEUE     attente dans le ring jusqu'à task_protection (plus ancien
+ *             échantillon du lot: celui qui a pu franchir le seuil)
+ *   RMS       filtre + fenêtres RMS (prot_push du lot)
+ *   DECISION  invalidité + table d'éléments (prot_eval)
+ *   GPIO      pilotage des LED/sortie déclenchement (bts_set_state)
+ *   MMS       dépôt dans la file MMS -> publication UDP (thread émetteur)
+ *   E2E_GPIO  échantillon -> sortie GPIO pilotée (tous les cycles)
+ *   E2E_MMS   échantillon -> publication UDP (cycles en déclenchement)
+ *   FAST_GPIO échantillon -> sortie GPIO, élément rapide (thread d'acquisition)
+ *   FAST_MMS  échantillon -> publication UDP, élément rapide
+ */
+
+typedef enum {
+    LAT_ACQ = 0,
+    LAT_QUEUE,
+    LAT_RMS,
+    LAT_DECISION,
+    LAT_GPIO,
+    LAT_MMS,
+    LAT_E2E_GPIO,
+    LAT_E2E_MMS,
+    LAT_FAST_GPIO,
+    LAT_FAST_MMS,
+    LAT_COUNT
+} lat_stage_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t p50_ns;   // borne haute de la classe (<= max)
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double   mean_ns;
+} lat_summary_t;
+
+/** timespec -> ns */
+static inline int64_t lat_ts_ns(const struct timespec *t) {
+    return (int64_t)t->tv_sec * 1000000000LL + t->tv_nsec;
+}
+
+/** Horloge des étages (ns, CLOCK_MONOTONIC). */
+static inline int64_t lat_now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return lat_ts_ns(&t);
+}
+
+/** Ajoute une mesure (durées négatives comptées comme 0). */
+void        lat_record(lat_stage_t stage, int64_t ns);
+/** Résumé d'un étage (instantané non atomique entre classes, suffisant pour un percentile). */
+void        lat_summary(lat_stage_t stage, lat_summary_t *out);
+/** Remet tous les histogrammes à zéro. */
+void        lat_reset(void);
+/** Nom d'un étage ("acq", "queue", ...). */
+const char* lat_stage_name(lat_stage_t stage);
+/** JSON de tous les étages (µs). Retourne la longueur écrite. */
+int         lat_build_json(char *buf, size_t sz);
+
+#ifdef __cplusplus
+}
+#endif
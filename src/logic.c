@@ -0,0 +1,252 @@
+// src/logic.c
+#include "logic.h"
+#include "elem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+
+#define LOGIC_BIT(k)  (1u << (k))
+#define LOGIC_MASK_A  (LOGIC_BIT(ELEM_IOC) | LOGIC_BIT(ELEM_TOC))
+#define LOGIC_MASK_V  (LOGIC_BIT(ELEM_UV)  | LOGIC_BIT(ELEM_OV))
+#define LOGIC_EPS_S   1e-9   // tolérance de cumul des dt (100 x 10 ms = 1 s)
+
+_Static_assert(ELEM_KIND_COUNT <= 4, "table de vérité sur 4 bits");
+
+typedef struct {
+    const char   *s;     // expression complète (positions d'erreur)
+    const char   *p;     // curseur
+    logic_prog_t *g;
+    char         *err;
+    size_t        errsz;
+    int           failed;
+} logic_parser_t;
+
+static int parse_or(logic_parser_t *ps);
+
+static void fail(logic_parser_t *ps, const char *msg) {
+    if (ps->failed) return;
+    ps->failed = 1;
+    if (ps->err && ps->errsz)
+        snprintf(ps->err, ps->errsz, "%s (position %d)", msg, (int)(ps->p - ps->s));
+}
+
+static void skip_ws(logic_parser_t *ps) {
+    while (isspace((unsigned char)*ps->p)) ps->p++;
+}
+
+/* Mot-clé entier (non suivi d'un caractère alphanumérique) */
+static int accept_word(logic_parser_t *ps, const char *w) {
+    skip_ws(ps);
+    size_t n = strlen(w);
+    if (strncasecmp(ps->p, w, n) != 0 || isalnum((unsigned char)ps->p[n])) return 0;
+    ps->p += n;
+    return 1;
+}
+
+static int accept_char(logic_parser_t *ps, char c) {
+    skip_ws(ps);
+    if (*ps->p != c) return 0;
+    ps->p++;
+    return 1;
+}
+
+static void emit(logic_parser_t *ps, logic_opcode_t op, unsigned a, unsigned b) {
+    logic_prog_t *g = ps->g;
+    if (g->n_ops >= LOGIC_MAX_OPS) { fail(ps, "expression trop longue"); return; }
+    g->ops[g->n_ops++] = (logic_op_t){ (uint8_t)op, (uint8_t)a, (uint8_t)b };
+}
+
+/* Entier décimal; retourne -1 si absent */
+static long parse_num(logic_parser_t *ps) {
+    skip_ws(ps);
+    if (!isdigit((unsigned char)*ps->p)) return -1;
+    long v = 0;
+    while (isdigit((unsigned char)*ps->p)) {
+        if (v < 100000000L) v = v * 10 + (*ps->p - '0');
+        ps->p++;
+    }
+    return v;
+}
+
+/* Temporisation: tpu(ms x) / tdo(ms x) */
+static int parse_timer(logic_parser_t *ps, logic_opcode_t op) {
+    if (!accept_char(ps, '(')) { fail(ps, "'(' attendue"); return -1; }
+    long ms = parse_num(ps);
+    if (ms < 0) { fail(ps, "délai (ms) attendu"); return -1; }
+    if (parse_or(ps) != 0) return -1;
+    if (!accept_char(ps, ')')) { fail(ps, "')' attendue"); return -1; }
+    logic_prog_t *g = ps->g;
+    if (g->n_timers >= LOGIC_MAX_TIMERS) { fail(ps, "trop de temporisations"); return -1; }
+    g->delay_s[g->n_timers] = (double)ms / 1000.0;
+    emit(ps, op, (unsigned)g->n_timers++, 0);
+    return ps->failed ? -1 : 0;
+}
+
+/* Vote: k of( x y ... ) */
+static int parse_vote(logic_parser_t *ps, long k) {
+    if (!accept_char(ps, '(')) { fail(ps, "'(' attendue"); return -1; }
+    int n = 0;
+    while (!accept_char(ps, ')')) {
+        if (!*ps->p) { fail(ps, "')' attendue"); return -1; }
+        if (parse_or(ps) != 0) return -1;
+        n++;
+    }
+    if (n == 0 || k < 1 || k > n || n > LOGIC_STACK) { fail(ps, "vote k parmi n invalide"); return -1; }
+    emit(ps, LOGIC_OP_VOTE, (unsigned)k, (unsigned)n);
+    return ps->failed ? -1 : 0;
+}
+
+static int parse_unary(logic_parser_t *ps) {
+    skip_ws(ps);
+    if (accept_char(ps, '!') || accept_word(ps, "not")) {
+        if (parse_unary(ps) != 0) return -1;
+        emit(ps, LOGIC_OP_NOT, 0, 0);
+        return ps->failed ? -1 : 0;
+    }
+    if (accept_char(ps, '(')) {
+        if (parse_or(ps) != 0) return -1;
+        if (!accept_char(ps, ')')) { fail(ps, "')' attendue"); return -1; }
+        return 0;
+    }
+    if (accept_word(ps, "tpu")) return parse_timer(ps, LOGIC_OP_TPU);
+    if (accept_word(ps, "tdo")) return parse_timer(ps, LOGIC_OP_TDO);
+    if (accept_word(ps, "a"))   { emit(ps, LOGIC_OP_IN, LOGIC_MASK_A, 0); return ps->failed ? -1 : 0; }
+    if (accept_word(ps, "v"))   { emit(ps, LOGIC_OP_IN, LOGIC_MASK_V, 0); return ps->failed ? -1 : 0; }
+
+    const char *at = ps->p;
+    long num = parse_num(ps);
+    if (num < 0) { fail(ps, "opérande attendu"); return -1; }
+    if (strncasecmp(ps->p, "of", 2) == 0 && !isalnum((unsigned char)ps->p[2])) {
+        ps->p += 2;
+        return parse_vote(ps, num);
+    }
+    for (int k = 0; k < ELEM_KIND_COUNT; ++k) {
+        if (num == (long)strtol(elem_kind_name((elem_kind_t)k), NULL, 10)) {
+            emit(ps, LOGIC_OP_IN, LOGIC_BIT(k), 0);
+            return ps->failed ? -1 : 0;
+        }
+    }
+    ps->p = at;
+    fail(ps, "élément inconnu (50, 51, 27, 59, A, V)");
+    return -1;
+}
+
+static int parse_and(logic_parser_t *ps) {
+    if (parse_unary(ps) != 0) return -1;
+    while (accept_char(ps, '&') || accept_word(ps, "and")) {
+        if (parse_unary(ps) != 0) return -1;
+        emit(ps, LOGIC_OP_AND, 0, 0);
+    }
+    return ps->failed ? -1 : 0;
+}
+
+static int parse_or(logic_parser_t *ps) {
+    if (parse_and(ps) != 0) return -1;
+    while (accept_char(ps, '|') || accept_word(ps, "or")) {
+        if (parse_and(ps) != 0) return -1;
+        emit(ps, LOGIC_OP_OR, 0, 0);
+    }
+    return ps->failed ? -1 : 0;
+}
+
+/* Machine à pile; st = NULL: temporisations ignorées (table de vérité) */
+static int logic_run(const logic_prog_t *g, logic_state_t *st, unsigned kinds, double dt_s) {
+    uint8_t stk[LOGIC_STACK];
+    int sp = 0;
+    for (int i = 0; i < g->n_ops; ++i) {
+        const logic_op_t *o = &g->ops[i];
+        switch (o->op) {
+        case LOGIC_OP_IN:  stk[sp++] = (kinds & o->a) != 0; break;
+        case LOGIC_OP_NOT: stk[sp - 1] ^= 1; break;
+        case LOGIC_OP_AND: sp--; stk[sp - 1] &= stk[sp]; break;
+        case LOGIC_OP_OR:  sp--; stk[sp - 1] |= stk[sp]; break;
+        case LOGIC_OP_VOTE: {
+            int cnt = 0;
+            for (int j = 0; j < o->b; ++j) cnt += stk[--sp];
+            stk[sp++] = cnt >= o->a;
+            break;
+        }
+        case LOGIC_OP_TPU: {
+            int x = stk[sp - 1];
+            if (!st) break;
+            if (x) {
+                st->acc[o->a] = st->prev[o->a] ? st->acc[o->a] + dt_s : 0.0;
+                st->out[o->a] = st->acc[o->a] >= g->delay_s[o->a] - LOGIC_EPS_S;
+            } else {
+                st->acc[o->a] = 0.0;
+                st->out[o->a] = 0;
+            }
+            st->prev[o->a] = (uint8_t)x;
+            stk[sp - 1] = st->out[o->a];
+            break;
+        }
+        case LOGIC_OP_TDO: {
+            int x = stk[sp - 1];
+            if (!st) break;
+            if (x) {
+                st->acc[o->a] = 0.0;
+                st->out[o->a] = 1;
+            } else if (st->out[o->a]) {
+                if (!st->prev[o->a]) st->acc[o->a] += dt_s; // chute au cycle précédent ou avant
+                st->out[o->a] = st->acc[o->a] < g->delay_s[o->a] - LOGIC_EPS_S;
+            }
+            st->prev[o->a] = (uint8_t)x;
+            stk[sp - 1] = st->out[o->a];
+            break;
+        }
+        default: break;
+        }
+    }
+    return sp ? stk[sp - 1] : 0;
+}
+
+int logic_compile(logic_prog_t *g, const char *expr, char *err, size_t errsz) {
+    memset(g, 0, sizeof(*g));
+    if (err && errsz) err[0] = '\0';
+    if (!expr) expr = "";
+    if (strcasecmp(expr, "any") == 0)  expr = "A | V";
+    if (strcasecmp(expr, "both") == 0) expr = "A & V";
+
+    logic_parser_t ps = { expr, expr, g, err, errsz, 0 };
+    if (parse_or(&ps) == 0) {
+        skip_ws(&ps);
+        if (*ps.p) fail(&ps, "caractère inattendu");
+    }
+    if (ps.failed) { memset(g, 0, sizeof(*g)); return -1; }
+
+    /* Profondeur de pile (bornée pour l'évaluation) */
+    int sp = 0;
+    for (int i = 0; i < g->n_ops; ++i) {
+        switch (g->ops[i].op) {
+        case LOGIC_OP_IN:   sp++; break;
+        case LOGIC_OP_AND:
+        case LOGIC_OP_OR:   sp--; break;
+        case LOGIC_OP_VOTE: sp -= g->ops[i].b - 1; break;
+        default: break;
+        }
+        if (sp > LOGIC_STACK) {
+            if (err && errsz) snprintf(err, errsz, "expression trop imbriquée");
+            memset(g, 0, sizeof(*g));
+            return -1;
+        }
+    }
+
+    /* Logique combinatoire: table de vérité sur les 16 masques d'éléments */
+    if (g->n_timers == 0) {
+        for (unsigned m = 0; m < 16; ++m) {
+            if (logic_run(g, NULL, m, 0.0)) g->tt |= (uint16_t)(1u << m);
+        }
+    }
+    return 0;
+}
+
+void logic_reset(logic_state_t *s) {
+    memset(s, 0, sizeof(*s));
+}
+
+int logic_eval(const logic_prog_t *g, logic_state_t *s, unsigned kinds, double dt_s) {
+    if (g->n_timers == 0) return (g->tt >> (kinds & 15u)) & 1;
+    return logic_run(g, s, kinds, dt_s);
+}
@@ -0,0 +1,80 @@
+// src/logic.h
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * LOGIC: logique de déclenchement configurable (clé trip_logic), compilée une
+ * fois au chargement de la config en bytecode postfixé plat, évaluée par voie
+ * à chaque cycle sur le masque des éléments déclenchés de la voie.
+ *
+ * Syntaxe (insensible à la casse, sans virgule: contrainte du format config):
+ *   50 51 27 59        sortie de l'élément de la voie
+ *   A  V               50|51, 27|59
+ *   !x  not x          négation
+ *   x & y  x and y     et (prioritaire sur ou)
+ *   x | y  x or y      ou
+ *   (x)                groupement
+ *   2of(x y z)         vote k parmi n (opérandes séparés par des blancs)
+ *   tpu(ms x)          temporisation à l'enclenchement: x vrai depuis ms
+ *   tdo(ms x)          temporisation au déclenchement: x maintenu ms après sa chute
+ *   any / both         A | V  /  A & V (valeurs historiques)
+ * Sans temporisation, le programme est réduit à une table de vérité de 16
+ * bits (une entrée par masque d'éléments): évaluation = un décalage.
+ */
+
+#define LOGIC_MAX_OPS     64
+#define LOGIC_MAX_TIMERS  8
+#define LOGIC_STACK       32
+
+typedef enum {
+    LOGIC_OP_IN = 0,   // empile (masque & a) != 0
+    LOGIC_OP_NOT,
+    LOGIC_OP_AND,
+    LOGIC_OP_OR,
+    LOGIC_OP_VOTE,     // dépile b opérandes, empile (vrais >= a)
+    LOGIC_OP_TPU,      // temporisation a (index) à l'enclenchement
+    LOGIC_OP_TDO       // temporisation a (index) au déclenchement
+} logic_opcode_t;
+
+typedef struct {
+    uint8_t op;
+    uint8_t a;
+    uint8_t b;
+} logic_op_t;
+
+typedef struct {
+    int        n_ops;
+    logic_op_t ops[LOGIC_MAX_OPS];
+    int        n_timers;
+    double     delay_s[LOGIC_MAX_TIMERS];
+    uint16_t   tt;          // table de vérité (n_timers == 0)
+} logic_prog_t;
+
+/** État des temporisations d'une voie. */
+typedef struct {
+    double  acc[LOGIC_MAX_TIMERS];  // temps écoulé (s)
+    uint8_t prev[LOGIC_MAX_TIMERS]; // entrée au cycle précédent
+    uint8_t out[LOGIC_MAX_TIMERS];
+} logic_state_t;
+
+/**
+ * Compile une expression. Retourne 0 si OK, -1 sinon (message dans err,
+ * si non NULL, avec la position de l'erreur).
+ */
+int  logic_compile(logic_prog_t *g, const char *expr, char *err, size_t errsz);
+/** Remet les temporisations à zéro. */
+void logic_reset(logic_state_t *s);
+/**
+ * Évalue le programme: kinds = éléments déclenchés (bit 1 << elem_kind_t),
+ * dt_s = temps écoulé depuis l'évaluation précédente. Retourne 0/1.
+ */
+int  logic_eval(const logic_prog_t *g, logic_state_t *s, unsigned kinds, double dt_s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,103 +4,348 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <gpiod.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 
 #include "scheduler.h"
 #include "bea.h"
+#include "acq.h"
+#include "prot.h"
+#include "fast.h"
 #include "bel.h"
-#include "bom.h"
 #include "bts.h"
 #include "mms.h"
 #include "config.h"
 #include "ArkStudio.h"
 #include "watchdog.h"
+#include "lat.h"
 
 #define CHIP "/dev/gpiochip0"
 
-/* Active/désactive le mode simulation pour la démo */
-#define SIMULATION 1
-
 /* ----------- Globals ----------- */
 static bea_t bea;
 static bel_t bel;
 static bts_t bts;
 
-static bom_t bomA; /* Courant */
-static bom_t bomV; /* Tension */
+static prot_t prot; /* RMS A/V + BOM A/V + logique de déclenchement, par voie */
+static fast_t fast; /* 50 HS instantané, évalué dans le thread d'acquisition */
+
+/* Sortie de déclenchement pilotée par task_protection (RT) et par le chemin
+ * rapide (thread d'acquisition): héritage de priorité (cf. main), le
+ * détenteur préempté par un thread intermédiaire est remonté */
+static pthread_mutex_t bts_mtx;
+
+/* Config relevée par le thread NRT dans prot_cfg, appliquée à prot par le
+ * thread RT (prot n'est touché que par task_protection: pas de verrou dans le
+ * cycle). prot_reload: 0 = prot_cfg au thread NRT, 1 = remis au thread RT. */
+static prot_cfg_t prot_cfg;
+static atomic_int prot_reload = 0;
+static int prot_pending = 0;  /* relevé en attente (cycle RT pas encore passé) */
+
+static void post_prot_config(void)
+{
+    prot_pending = 1;
+    if (atomic_load_explicit(&prot_reload, memory_order_acquire)) return; /* repris par task_reload_config */
+    prot_pending = 0;
+    prot_config_release(&prot_cfg); /* fenêtres remplacées au cycle précédent */
+    if (prot_config_load(&prot_cfg, &prot) != 0) {
+        printf("[WARN] Réglages de protection non appliqués (allocation).\n");
+        return;
+    }
+    atomic_store_explicit(&prot_reload, 1, memory_order_release); /* appliqué au prochain cycle RT */
+}
+
+/* Canal watchdog du thread d'acquisition (kické à chaque échantillon) */
+static int wd_acq = -1;
+
+/* Table de la config, sinon linéaire par défaut (clé absente ou invalide):
+ * un rechargement donne la même table qu'un redémarrage sur le même fichier */
+static void calib_from_config(calib_table_t *t, const char *s, double per_us, int c, const char *key)
+{
+    if (s[0] && calib_parse(t, s) == 0) return;
+    if (s[0]) printf("[WARN] Voie %d: table %s invalide, calibration linéaire par défaut.\n", c, key);
+    calib_build_linear(t, per_us, 0.0);
+}
+
+/* Tables de calibration (config) publiées d'un bloc, sans arrêter l'acquisition.
+ * Non publiées (file de retrait pleine): reprises par task_reload_config. */
+static int calib_pending = 0;
+
+static void apply_calib(void)
+{
+    bea_calib_t *set = bea_calib_edit(&bea);
+    calib_pending = 1;
+    if (!set) return;
+    for (int c = 0; c < bea.nch; ++c) {
+        const char *a = config_get_calib_A(c)[0] ? config_get_calib_A(c) : config_get_calib_A(-1);
+        const char *v = config_get_calib_V(c)[0] ? config_get_calib_V(c) : config_get_calib_V(-1);
+        calib_from_config(&set->current[c], a, BEA_CALIB_A_PER_US, c, "calib_A");
+        calib_from_config(&set->voltage[c], v, BEA_CALIB_V_PER_US, c, "calib_V");
+    }
+    if (bea_calib_publish(&bea, set) != 0) {
+        free(set);
+        return;
+    }
+    calib_pending = 0;
+}
+
+static void apply_fast(void)
+{
+    fast_configure(&fast, config_get_fast_pickup_A(), config_get_fast_count(),
+                   config_get_sample_rate_hz(), config_get_nominal_freq_hz());
+}
+
+/* Thread d'acquisition, chaque échantillon: 50 HS -> sortie + MMS sans attendre le cycle APS */
+static void fast_path(const acq_sample_t *s, void *ctx)
+{
+    (void)ctx;
+    watchdog_mark(wd_acq, "sample");
+    watchdog_kick_ch(wd_acq);
+    double peak;
+    if (!fast_push(&fast, &s->blk, &peak)) return;
+    int64_t t_sample = lat_ts_ns(&s->ts);
+    pthread_mutex_lock(&bts_mtx);
+    bts_set_state(&bts, 1); /* LED rouge ON */
+    pthread_mutex_unlock(&bts_mtx);
+    lat_record(LAT_FAST_GPIO, lat_now_ns() - t_sample);
+    mms_post(peak, t_sample, MMS_SRC_FAST);
+}
+
+/* ----------- Comptes rendus RT -> NRT ----------- */
+
+/* task_protection ne journalise ni n'imprime (mlog_mtx, verrous stdio et
+ * localtime partagés avec les threads NRT): changements d'état et invalidités
+ * sont déposés dans un ring SPSC (RT producteur, NRT consommateur) signalé
+ * par un eventfd du réacteur NRT, qui horodate, journalise et imprime.
+ * Ring plein: compte rendu perdu (compté, signalé côté NRT). */
+typedef enum { REP_TRIP_ON = 0, REP_TRIP_OFF, REP_INVALID, REP_CH_INVALID } rep_type_t;
+
+typedef struct {
+    int             type;      // rep_type_t
+    int             fast_on;   // élément rapide actif au moment de la décision
+    struct timespec wall;      // CLOCK_REALTIME de la décision
+    prot_result_t   res;
+} prot_report_t;
+
+#define REPORT_RING_SZ 16   // doit être une puissance de 2
+
+static prot_report_t    rep_buf[REPORT_RING_SZ];
+static _Atomic uint32_t rep_head = 0;
+static _Atomic uint32_t rep_tail = 0;
+static _Atomic uint64_t rep_lost = 0;
+static int              rep_efd  = -1;
+
+/* RT: dépôt non bloquant + réveil du réacteur NRT */
+static void report_post(rep_type_t type, const prot_result_t *res, int fast_on)
+{
+    uint32_t head = atomic_load_explicit(&rep_head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&rep_tail, memory_order_acquire);
+    if (head - tail >= REPORT_RING_SZ) {
+        atomic_fetch_add_explicit(&rep_lost, 1, memory_order_relaxed);
+        return;
+    }
+    prot_report_t *r = &rep_buf[head & (REPORT_RING_SZ - 1)];
+    r->type    = (int)type;
+    r->fast_on = fast_on;
+    clock_gettime(CLOCK_REALTIME, &r->wall);
+    if (res) r->res = *res;
+    else r->res.nch = 0;
+    atomic_store_explicit(&rep_head, head + 1, memory_order_release);
+    if (rep_efd >= 0) {
+        uint64_t one = 1;
+        ssize_t w = write(rep_efd, &one, sizeof(one));
+        (void)w;
+    }
+}
+
+static void report_print(const prot_report_t *r)
+{
+    const prot_result_t *res = &r->res;
+    char ts[64];
+    struct tm tm;
+    localtime_r(&r->wall.tv_sec, &tm);
+    strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", &tm);
+
+    switch (r->type) {
+    case REP_TRIP_ON:
+        conf_add_log("TRIP_ON", "breaker -> RED (déclenchement)");
+        for (int c = 0; c < res->nch; ++c) {
+            if (!res->ch_trip[c]) continue;
+            char kinds[32] = "";
+            for (int k = 0; k < ELEM_KIND_COUNT; ++k) {
+                if (res->kinds[c] & (1u << k)) {
+                    strncat(kinds, kinds[0] ? "+" : "", sizeof(kinds) - strlen(kinds) - 1);
+                    strncat(kinds, elem_kind_name((elem_kind_t)k), sizeof(kinds) - strlen(kinds) - 1);
+                }
+            }
+            printf("[INFO] Voie %d [%s]: RMS A=%.2f V=%.2f DC=%.2f crête=%.2f H2=%.1f%% THD_A=%.1f%% THD_V=%.1f%%\n", c, kinds,
+                   res->rmsA[c], res->rmsV[c], res->statA[c].mean, res->statA[c].crest,
+                   res->harmA[c].mag[0] > 0 ? 100.0 * res->harmA[c].mag[1] / res->harmA[c].mag[0] : 0.0,
+                   100.0 * res->harmA[c].thd, 100.0 * res->harmV[c].thd);
+        }
+        if (r->fast_on) printf("[INFO] Élément rapide 50 HS actif (seuil %.2f A instantané)\n", config_get_fast_pickup_A());
+        printf("[ALERTE] Déclenchement! à %s\n.",ts);
+        break;
+    case REP_TRIP_OFF:
+        conf_add_log("TRIP_OFF", "breaker -> GREEN (normal)");
+        printf("[INFO] Retour à l'état normal à %s\n.",ts);
+        break;
+    case REP_INVALID:
+        printf("[ERROR] Mesure invalide sur toutes les voies (A0=%.2f, V0=%.2f)\n", res->rmsA[0], res->rmsV[0]);
+        break;
+    case REP_CH_INVALID:
+        for (int c = 0; c < res->nch; ++c) {
+            if (!res->ch_valid[c]) printf("[WARN] Voie %d: mesure invalide (%.0f%% d'échantillons rejetés)\n", c, 100.0 * res->loss[c]);
+        }
+        break;
+    }
+}
+
+/* NRT: consommateur unique (réacteur NRT, et task_watchdog en filet) */
+static void report_drain(void)
+{
+    static uint64_t last_lost = 0;
+    uint32_t tail = atomic_load_explicit(&rep_tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&rep_head, memory_order_acquire);
+    for (; tail != head; ++tail) {
+        report_print(&rep_buf[tail & (REPORT_RING_SZ - 1)]);
+        atomic_store_explicit(&rep_tail, tail + 1, memory_order_release);
+    }
+    uint64_t lost = atomic_load_explicit(&rep_lost, memory_order_relaxed);
+    if (lost != last_lost) {
+        printf("[WARN] %llu compte(s) rendu(s) de protection perdu(s) (file pleine).\n",
+               (unsigned long long)(lost - last_lost));
+        last_lost = lost;
+    }
+}
+
+static void report_on_event(int fd, uint32_t events, void *ctx)
+{
+    (void)events; (void)ctx;
+    uint64_t v;
+    ssize_t r = read(fd, &v, sizeof(v));
+    (void)r;
+    report_drain();
+}
 
 /* ----------- Tasks ----------- */
 
+/* Scheduler APS (global: statistiques lues par le serveur HTTP) */
+static aps_task_t      tasks_buf[8];
+static aps_scheduler_t sch;
+/* Noms par indice de tâche (renseignés par add_task) */
+static const char *task_names[8];
+
+/* Ajoute une tâche nommée (offset 0). Retourne son indice, -1 si refusée. */
+static int add_task(const char *name, aps_task_fn_t fn, uint32_t period_ms, uint32_t budget_us, aps_class_t cls)
+{
+    int idx = aps_add_task(&sch, fn, NULL, period_ms, 0, budget_us, cls);
+    if (idx < 0) {
+        printf("[ERROR] Tâche %s refusée par le scheduler (%s).\n", name, idx == -2 ? "non ordonnançable" : "table pleine");
+        return -1;
+    }
+    task_names[idx] = name;
+    return idx;
+}
+
+/* GET /tasks: retard de démarrage et durée d'exécution par tâche */
+static int tasks_json(char *buf, size_t sz)
+{
+    return aps_build_json(&sch, task_names, (int)(sizeof(task_names) / sizeof(task_names[0])), buf, sz);
+}
+
+/* GET /budget: utilisation et temps de réponse pire cas (analyse rate-monotonic) */
+static int budget_json(char *buf, size_t sz)
+{
+    return aps_budget_json(&sch, task_names, (int)(sizeof(task_names) / sizeof(task_names[0])), buf, sz);
+}
+
 /* RT: calcule RMS A & V, applique seuil/TMS, pilote LEDs, envoie MMS */
 static void task_protection(void *ctx)
 {
     (void)ctx;
     static int last_state = -1; /* -1=unknown, 0=normal (vert), 1=trip (rouge) */
+    watchdog_mark(WATCHDOG_CH_PROT, "start");
+
+    if (atomic_load_explicit(&prot_reload, memory_order_acquire)) {
+        prot_apply_config(&prot, &prot_cfg);
+        atomic_store_explicit(&prot_reload, 0, memory_order_release);
+    }
+
+    /* Vide (sans bloquer) le ring alimenté par le thread d'acquisition, quel que
+     * soit le backend, et alimente les fenêtres RMS glissantes (O(1) par échantillon). */
+    static acq_sample_t drained[ACQ_RING_SZ];
+    size_t n = acq_drain(drained, ACQ_RING_SZ);
+    watchdog_mark(WATCHDOG_CH_PROT, "drain");
+    int64_t t_drain = lat_now_ns();
+    /* Latences mesurées depuis le plus ancien échantillon du lot: celui qui a pu franchir le seuil */
+    int64_t t_sample = n ? lat_ts_ns(&drained[0].ts) : t_drain;
+    if (n) lat_record(LAT_QUEUE, t_drain - t_sample);
+    for (size_t i = 0; i < n; ++i) {
+        prot_push(&prot, &drained[i].blk);
+    }
+    watchdog_mark(WATCHDOG_CH_PROT, "rms");
+    int64_t t_rms = lat_now_ns();
+    lat_record(LAT_RMS, t_rms - t_drain);
+
+    /* RMS -> invalidité -> seuil + TMS -> logique (cf. prot.c) */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    prot_result_t res;
+    prot_eval(&prot, &now, &res);
+    watchdog_mark(WATCHDOG_CH_PROT, "decision");
+    int64_t t_dec = lat_now_ns();
+    lat_record(LAT_DECISION, t_dec - t_rms);
 
-    double rmsA = 0.0, rmsV = 0.0;
-
-#if SIMULATION
-    /* Démo : valeurs fixes pour valider déclenchement + MMS rapidement */
-    rmsA = 560.0;  /* au-dessus du seuil 550 par défaut -> déclenchement après TMS */
-    rmsV = 240.0;  /* proche de 230 V nominal (informationnel) */
-#else
-    /* Mesure réelle côté HC-SR04 */
-    int smp    = config_get_samples();
-    int slp_us = config_get_sleep_ms() * 1000;
-    rmsA = bea_rms_current_A(&bea, smp, slp_us);
-    rmsV = bea_rms_voltage_V(&bea, smp, slp_us);
-#endif
-
-    /* Invalidité (ex: timeout capteur) */
-    if (rmsA < 0 || rmsV < 0) {
-        printf("[ERROR] Mesure invalide (A=%.2f, V=%.2f)\n", rmsA, rmsV);
-        bom_set_invalid(&bomA, 1);
-        bom_set_invalid(&bomV, 1);
+    /* Invalidité (ex: timeout capteur): toutes les voies */
+    if (!res.valid) {
+        report_post(REP_INVALID, &res, 0);
         watchdog_kick(); /* évite FAULT inutile si capteur capricieux */
         return;
-    } else {
-        bom_set_invalid(&bomA, 0);
-        bom_set_invalid(&bomV, 0);
+    }
+    /* Voie isolée invalide: les autres départs restent protégés */
+    for (int c = 0; c < res.nch; ++c) {
+        if (!res.ch_valid[c]) { report_post(REP_CH_INVALID, &res, 0); break; }
+    }
+
+    /* Valeur MMS: plus fort courant parmi les voies déclenchées (toutes si seul le 50 HS l'est) */
+    double rmsA = -1.0;
+    for (int c = 0; c < res.nch; ++c) {
+        if ((res.ch_trip[c] || !res.trip) && res.rmsA[c] > rmsA) rmsA = res.rmsA[c];
     }
 
-    
+    /* Décision du cycle, maintenue tant que l'élément rapide n'est pas retombé
+     * (relu sous verrou: pas de retour au vert sur un front rapide concurrent) */
+    pthread_mutex_lock(&bts_mtx);
+    int fast_on = fast_active(&fast);
+    int trip = res.trip || fast_on;
+    bts_set_state(&bts, trip); /* LED rouge / verte ON */
+    pthread_mutex_unlock(&bts_mtx);
+    watchdog_mark(WATCHDOG_CH_PROT, "gpio");
+    int64_t t_gpio = lat_now_ns();
+    lat_record(LAT_GPIO, t_gpio - t_dec);
+    if (n) lat_record(LAT_E2E_GPIO, t_gpio - t_sample);
 
-    /* Seuil + TMS sur chaque voie */
-    int tripA = bom_check_with_tms(&bomA, rmsA);
-    int tripV = bom_check_with_tms(&bomV, rmsV);
-    // printf("[INFO] TRIPA et V =%d , %d\n",tripA,tripV);
-    /* Logique de déclenchement : ANY (A OU V) */
-    int trip = (tripA || tripV);
     // printf("[INFO] TRIP =%di",trip);
     if (trip) {
-        bts_set_state(&bts, 1); /* LED rouge ON */
+        /* MMS-like : valeur A (format actuel "MMS: value=.. ts=..") déposée dans la
+         * file du thread émetteur: ni socket ni printf dans le cycle RT. */
+        mms_post(rmsA, n ? t_sample : 0, MMS_SRC_APS);
+        watchdog_mark(WATCHDOG_CH_PROT, "mms");
+
         if (last_state != 1) {
-            // printf("ici0");
-            time_t now = time(NULL);
-            char ts[64];
-            strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", localtime(&now));
-
-            conf_add_log("TRIP_ON", "breaker -> RED (déclenchement)");
-            printf("[INFO] RMS A=%.2f V=%.2f\n", rmsA, rmsV);
-            printf("[ALERTE] Déclenchement! à %s\n.",ts);
+            report_post(REP_TRIP_ON, &res, fast_on); /* journal et console côté NRT */
             last_state = 1;
         }
-        /* MMS-like : envoie la valeur A (format actuel "MMS: value=.. ts=..") */
-        // printf("ici1");
-        mms_send(rmsA);
-        
     } else {
-        bts_set_state(&bts, 0); /* LED verte ON */
         if (last_state != 0) {
-            // printf("ici2");
-            time_t now = time(NULL);
-            char ts[64];
-            strftime(ts, sizeof(ts), "%Y-%m-%d %H:%M:%S", localtime(&now));
-            conf_add_log("TRIP_OFF", "breaker -> GREEN (normal)");
-            printf("[INFO] Retour à l'état normal à %s\n.",ts);
+            report_post(REP_TRIP_OFF, NULL, 0);
             last_state = 0;
         }
-        // printf("ici3");
     }
 
     /* Heartbeat RT */
@@ -121,8 +366,10 @@ static void task_reload_config(void *ctx)
             double thr_V   = config_get_threshold_V();
             int    tmsms_V = config_get_tms_V_ms();
             printf("[INFO] thr_A =%.2f",thr_A) ;
-            bom_init(&bomA, thr_A, tmsms_A);
-            bom_init(&bomV, thr_V, tmsms_V);
+            post_prot_config();
+            acq_set_rate(config_get_sample_rate_hz());
+            apply_calib();
+            apply_fast();
 
             char info[128];
             snprintf(info, sizeof(info), "APPLIED thr_A=%.3f tms_A=%d thr_V=%.3f tms_V=%d smp=%d slp=%d mode=%s",
@@ -132,17 +379,107 @@ static void task_reload_config(void *ctx)
         }
         conf_clear_reload_flag();
     }
+    bea_calib_reclaim(&bea); /* anciens jeux de calibration hors période de grâce */
+    if (calib_pending) apply_calib(); /* publication refusée au rechargement précédent */
+    if (prot_pending) post_prot_config();
+    acq_capture_sync();      /* capture sur disque toutes les 500 ms (main n'atteint pas acq_stop) */
 }
 
-/* NRT: watchdog (détection retard RT) */
+/* NRT: watchdog (canaux protection et acquisition), post-mortem sur GET /watchdog */
 static void task_watchdog(void *ctx)
 {
     (void)ctx;
-    if (watchdog_check()) {
-        printf("[FAULT] Watchdog: task_protection en retard > %d ms\n",
-               watchdog_get_timeout_ms());
-        /* Option: conf_add_log("FAULT","watchdog timeout"); */
+    report_drain(); /* filet: comptes rendus RT si l'eventfd n'a pas pu être enregistré */
+    int expired = watchdog_check_all();
+    for (int i = 0; i < expired; ++i) {
+        watchdog_pm_t pm;
+        if (watchdog_postmortem(i, &pm) != 0) break;
+        char info[128];
+        snprintf(info, sizeof(info), "%s: pas de kick depuis %.0f ms (échéance %d ms), dernier étage %s",
+                 pm.channel, (double)(pm.detected_ns - pm.last_kick_ns) / 1e6, pm.deadline_ms,
+                 pm.n ? pm.trace[pm.n - 1].stage : "-");
+        conf_add_log("FAULT", info);
+        printf("[FAULT] Watchdog %s\n", info);
+    }
+
+    /* Surcharge APS (délestage des tâches NRT): journalisée à chaque transition */
+    static aps_ovl_stats_t last_ovl;
+    aps_ovl_stats_t ovl;
+    aps_overload_stats(&sch, &ovl);
+    if (ovl.enters != last_ovl.enters || ovl.exits != last_ovl.exits) {
+        char info[96];
+        snprintf(info, sizeof(info), "%s (entrées=%llu sorties=%llu)",
+                 ovl.active ? "surcharge APS: délestage actif" : "fin de surcharge APS: tâches rétablies",
+                 (unsigned long long)ovl.enters, (unsigned long long)ovl.exits);
+        conf_add_log(ovl.active ? "APS_OVERLOAD" : "APS_RESTORE", info);
+        printf("[%s] %s\n", ovl.active ? "WARN" : "INFO", info);
+        last_ovl = ovl;
     }
+
+    /* Ordonnançabilité avec les durées mesurées: journalisée à chaque changement */
+    static aps_rta_t rta;
+    static int last_sched = 1;
+    aps_analyze(&sch, &rta);
+    if (rta.schedulable != last_sched) {
+        char info[128];
+        snprintf(info, sizeof(info), "%s (U=%.2f RT=%.2f NRT=%.2f)",
+                 rta.schedulable ? "ensemble APS de nouveau ordonnançable" : "ensemble APS non ordonnançable",
+                 rta.util_total, rta.util[APS_CLASS_RT], rta.util[APS_CLASS_NRT]);
+        conf_add_log(rta.schedulable ? "APS_BUDGET_OK" : "APS_BUDGET", info);
+        printf("[%s] %s\n", rta.schedulable ? "INFO" : "WARN", info);
+        last_sched = rta.schedulable;
+    }
+}
+
+/* NRT (source du réacteur): front sur l'entrée BEL, horodaté par le noyau */
+static void bel_on_event(int fd, uint32_t events, void *ctx)
+{
+    (void)fd; (void)events; (void)ctx;
+    struct timespec ts;
+    int v = bel_event_read(&bel, &ts);
+    if (v < 0) return;
+    char info[64];
+    snprintf(info, sizeof(info), "BEL line 24 -> %d (t=%ld.%09ld)", v, (long)ts.tv_sec, ts.tv_nsec);
+    conf_add_log("INPUT", info);
+    printf("[INFO] %s\n", info);
+}
+
+/* ----------- Backend d'acquisition ----------- */
+
+/* Choix à l'exécution (config "backend"): même binaire en production et en test */
+static int open_backend(struct gpiod_chip *chip)
+{
+    const char *be = config_get_backend();
+    int nch = config_get_channels();
+
+    if (strcmp(be, "synthetic") == 0) {
+        bea_synth_cfg_t sc;
+        memset(&sc, 0, sizeof(sc));
+        sc.freq_hz       = config_get_synth_freq_hz();
+        sc.current_rms_A = config_get_synth_current_A();
+        sc.voltage_rms_V = config_get_synth_voltage_V();
+        sc.noise_pct     = config_get_synth_noise_pct();
+        sc.fault_at_s    = config_get_synth_fault_at_ms() < 0 ? -1.0
+                         : config_get_synth_fault_at_ms() / 1000.0;
+        sc.fault_gain    = config_get_synth_fault_gain();
+        sc.fault_ch      = config_get_synth_fault_ch();
+        bea_synth_parse_harm(config_get_synth_harm_pct(), sc.harm_pct, BEA_SYNTH_MAX_HARM);
+        return bea_init_synthetic(&bea, nch, &sc);
+    }
+    if (strcmp(be, "replay") == 0) {
+        return bea_init_replay(&bea, config_get_replay_file(), config_get_replay_loop());
+    }
+    if (!chip) {
+        printf("[ERROR] Backend hardware sans chip GPIO.\n");
+        return -1;
+    }
+    unsigned trig[BEA_MAX_CH], echo[BEA_MAX_CH];
+    if (config_parse_lines(config_get_trig_lines(), trig, BEA_MAX_CH) < nch ||
+        config_parse_lines(config_get_echo_lines(), echo, BEA_MAX_CH) < nch) {
+        printf("[ERROR] trig_lines/echo_lines: %d offsets attendus.\n", nch);
+        return -1;
+    }
+    return bea_init_multi(chip, &bea, nch, trig, echo);
 }
 
 /* ----------- Entrée principale ----------- */
@@ -164,47 +501,112 @@ int main(void)
     printf("[INFO] Paramètres init: threshold_A=%.2f, TMS_A=%d ms,threshold_V=%.2f, TMS_V=%d ms, samples=%d, sleep=%d ms, mode=%s\n",
            thr_A, tms_A,thr_V, tms_V, smp, slp, config_get_mode());
 
-    /* GPIO chip */
+    /* GPIO chip (optionnel hors backend hardware: banc Linux sans GPIO) */
     struct gpiod_chip *chip = gpiod_chip_open(CHIP);
     if (!chip) {
         perror("gpiod_chip_open");
-        return 1;
+        if (strcmp(config_get_backend(), "hardware") == 0) return 1;
+        printf("[WARN] Pas de chip GPIO: sorties BTS/BEL désactivées (backend %s).\n",
+               config_get_backend());
     }
 
     /* Init BEA/BEL/BTS */
-    if (bea_init(chip, &bea) < 0) return 1;
-    if (bel_init(chip, &bel, 24, 1) < 0) return 1;   /* ex. bouton sur line 24, active-high */
-    if (bts_init(chip, &bts) < 0) return 1;
+    if (open_backend(chip) < 0) return 1;
+    printf("[INFO] Backend d'acquisition: %s (%d voie(s))\n", bea_backend_name(&bea), bea.nch);
+    apply_calib();
+    /* Capture binaire optionnelle des échantillons (rejeu hors ligne, cf. cap.h) */
+    if (config_get_capture_file()[0] != '\0') {
+        acq_capture_open(config_get_capture_file(), config_get_sample_rate_hz(), bea.nch);
+    }
+    if (chip) {
+        if (bel_init(chip, &bel, 24, 1) < 0) return 1;   /* ex. bouton sur line 24, active-high */
+        if (bts_init(chip, &bts) < 0) return 1;
+    }
 
-    /* Init BOM A et V (seuil/TMS identiques en format historique) */
-    bom_init(&bomA, thr_A, tms_A);
-    bom_init(&bomV, thr_V, tms_V);
+    /* Publication MMS par thread émetteur (file MPSC: cycle APS + chemin rapide) */
+    if (mms_start() != 0) {
+        printf("[WARN] Thread MMS non démarré: événements non publiés.\n");
+    }
+    /* Thread d'acquisition à cadence fixe (découplé du cycle APS), 50 HS sur chaque
+     * échantillon: démarré après BTS, que le chemin rapide pilote directement */
+    fast_init(&fast);
+    apply_fast();
+    /* Watchdog: protection (1500 ms par défaut) et acquisition (10 périodes d'échantillonnage
+     * au moins), avant le démarrage des threads qui les kickent */
+    watchdog_init(WATCHDOG_TIMEOUT_MS_DEFAULT);
+    int acq_deadline_ms = 10000 / config_get_sample_rate_hz();
+    wd_acq = watchdog_add_channel("acq", acq_deadline_ms > WATCHDOG_TIMEOUT_MS_DEFAULT
+                                         ? acq_deadline_ms : WATCHDOG_TIMEOUT_MS_DEFAULT);
+    pthread_mutexattr_t ma;
+    pthread_mutexattr_init(&ma);
+    if (pthread_mutexattr_setprotocol(&ma, PTHREAD_PRIO_INHERIT) != 0) {
+        printf("[WARN] Héritage de priorité indisponible pour la sortie BTS.\n");
+    }
+    pthread_mutex_init(&bts_mtx, &ma);
+    pthread_mutexattr_destroy(&ma);
+    acq_set_hook(fast_path, NULL);
+    acq_set_policy(aps_policy_from_name(config_get_acq_policy()),
+                   config_get_acq_priority(), config_get_acq_cpu());
+    if (acq_start(&bea, config_get_sample_rate_hz()) != 0) return 1;
 
-    /* MMS SCADA (multi-interfaces: 192.168.0.101 et 192.168.7.3) */
-    if (conf_start(9090) != 0) {
-        printf("[WARN] MMS HTTP non démarré.\n");
+    /* Chaîne de protection par voie: éléments 50/51/27/59 + fenêtres RMS (longueur = samples) */
+    if (prot_init(&prot, bea.nch, 0) != 0) {
+        printf("[ERROR] Allocation fenêtres RMS impossible.\n");
+        return 1;
     }
 
-    /* Watchdog (1500 ms par défaut) */
-    watchdog_init(WATCHDOG_TIMEOUT_MS_DEFAULT);
+    /* Scheduler APS: un thread par classe (RT: protection seule, NRT: le reste) */
+    aps_init(&sch, tasks_buf, (int)(sizeof(tasks_buf) / sizeof(tasks_buf[0])));
+    aps_set_class(&sch, APS_CLASS_RT, aps_policy_from_name(config_get_rt_policy()),
+                  config_get_rt_priority(), config_get_rt_cpu());
+    aps_set_class(&sch, APS_CLASS_NRT, aps_policy_from_name(config_get_nrt_policy()),
+                  config_get_nrt_priority(), config_get_nrt_cpu());
 
-    /* Scheduler APS */
-    aps_task_t      tasks_buf[8];
-    aps_scheduler_t sch;
-    aps_init(&sch, tasks_buf, 8);
+    /* Budgets déclarés (µs): remplacés dans l'analyse par la durée max mesurée si elle est plus grande */
+    /* RT: protection (100 ms), NRT: reload config et watchdog check (500 ms) */
+    int t_prot   = add_task("protection", task_protection, 100, 20000, APS_CLASS_RT);
+    int t_reload = add_task("reload_config", task_reload_config, 500, 50000, APS_CLASS_NRT);
+    int t_wd     = add_task("watchdog", task_watchdog, 500, 1000, APS_CLASS_NRT);
+    if (t_prot < 0 || t_reload < 0 || t_wd < 0) {
+        prot_free(&prot);
+        return 1;
+    }
+    /* Surcharge de la protection: rechargement suspendu, supervision étirée */
+    aps_set_criticality(&sch, t_reload, APS_CRIT_LO);
+    aps_set_criticality(&sch, t_wd, APS_CRIT_MID);
+    /* NRT: comptes rendus de task_protection (journal, console) dès leur dépôt */
+    rep_efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (rep_efd < 0 || aps_add_source(&sch, APS_CLASS_NRT, rep_efd, EPOLLIN, report_on_event, NULL) != 0) {
+        printf("[WARN] Comptes rendus de protection relevés par task_watchdog (500 ms).\n");
+    }
+    /* NRT: fronts BEL traités par le réacteur dès leur arrivée (pas de scrutation) */
+    if (bel_event_fd(&bel) >= 0 &&
+        aps_add_source(&sch, APS_CLASS_NRT, bel_event_fd(&bel), EPOLLIN, bel_on_event, NULL) != 0) {
+        printf("[WARN] Entrée BEL non enregistrée dans le réacteur NRT.\n");
+    }
 
-    /* RT: protection (100 ms) */
-    aps_add_task(&sch, task_protection, NULL, 100, 0);
-    /* NRT: reload config (500 ms) */
-    aps_add_task(&sch, task_reload_config, NULL, 500, 0);
-    /* NRT: watchdog check (500 ms) */
-    aps_add_task(&sch, task_watchdog, NULL, 500, 0);
+    /* MMS SCADA (multi-interfaces: 192.168.0.101 et 192.168.7.3), après l'ajout
+     * des tâches: GET /tasks lit leurs statistiques */
+    conf_add_endpoint("/latency", lat_build_json);
+    conf_add_endpoint("/tasks", tasks_json);
+    conf_add_endpoint("/budget", budget_json);
+    conf_add_endpoint("/watchdog", watchdog_build_json);
+    conf_add_endpoint("/acq", acq_build_json);
+    conf_add_endpoint("/mms", mms_build_json);
+    if (conf_start(9090) != 0) {
+        printf("[WARN] MMS HTTP non démarré.\n");
+    }
 
     printf("[INFO] Démarrage du scheduler...\n");
     aps_run(&sch);  /* boucle bloquante */
 
     /* Arrêt propre (si jamais aps_run retourne) */
+    acq_stop();
+    mms_stop();
     conf_stop();
-    gpiod_chip_close(chip);
+    prot_free(&prot);
+    prot_config_release(&prot_cfg);
+    bea_close(&bea);
+    if (chip) gpiod_chip_close(chip);
     return 0;
 }
@@ -0,0 +1,122 @@
+// src/median.c
+#include "median.h"
+#include <stdlib.h>
+
+/*
+ * Indices dans heap: 0 = médiane, 1..minCt = tas min (enfants 2i, 2i+1),
+ * -1..-maxCt = tas max (enfants 2i, 2i-1). Le parent de i est i/2
+ * (troncature vers 0), celui de 1 et -1 est la médiane.
+ */
+
+static inline int min_ct(const med_t *m) { return (m->ct - 1) / 2; }
+static inline int max_ct(const med_t *m) { return m->ct / 2; }
+
+static inline int less(const med_t *m, int i, int j) {
+    return m->data[m->heap[i]] < m->data[m->heap[j]];
+}
+
+static inline void exchange(med_t *m, int i, int j) {
+    int t = m->heap[i];
+    m->heap[i] = m->heap[j];
+    m->heap[j] = t;
+    m->pos[m->heap[i]] = i;
+    m->pos[m->heap[j]] = j;
+}
+
+/* Échange si heap[i] < heap[j]; retourne 1 si échangé. */
+static inline int cmp_exch(med_t *m, int i, int j) {
+    if (!less(m, i, j)) return 0;
+    exchange(m, i, j);
+    return 1;
+}
+
+/* Propriété de tas min à partir du lien (i/2, i), vers le bas */
+static void min_sort_down(med_t *m, int i) {
+    for (; i <= min_ct(m); i *= 2) {
+        if (i > 1 && i < min_ct(m) && less(m, i + 1, i)) ++i;
+        if (!cmp_exch(m, i, i / 2)) break;
+    }
+}
+
+/* Propriété de tas max à partir du lien (i/2, i), vers le bas (indices négatifs) */
+static void max_sort_down(med_t *m, int i) {
+    for (; i >= -max_ct(m); i *= 2) {
+        if (i < -1 && i > -max_ct(m) && less(m, i, i - 1)) --i;
+        if (!cmp_exch(m, i / 2, i)) break;
+    }
+}
+
+/* Remonte i dans le tas min, médiane comprise; 1 si la médiane a changé */
+static int min_sort_up(med_t *m, int i) {
+    while (i > 0 && cmp_exch(m, i, i / 2)) i /= 2;
+    return i == 0;
+}
+
+/* Remonte i dans le tas max, médiane comprise; 1 si la médiane a changé */
+static int max_sort_up(med_t *m, int i) {
+    while (i < 0 && cmp_exch(m, i / 2, i)) i /= 2;
+    return i == 0;
+}
+
+int med_init(med_t *m, int n) {
+    if (!m || n <= 0) return -1;
+    m->data = (double*)calloc((size_t)n, sizeof(double));
+    m->pos  = (int*)calloc((size_t)n * 2, sizeof(int));
+    if (!m->data || !m->pos) {
+        free(m->data);
+        free(m->pos);
+        m->data = NULL;
+        m->pos  = NULL;
+        return -1;
+    }
+    m->heap = m->pos + n + n / 2;  // milieu de la zone heap
+    m->n    = n;
+    m->idx  = 0;
+    m->ct   = 0;
+    // Remplissage initial alterné: médiane, max, min, max, min...
+    for (int k = n - 1; k >= 0; --k) {
+        m->pos[k] = ((k + 1) / 2) * ((k & 1) ? -1 : 1);
+        m->heap[m->pos[k]] = k;
+    }
+    return 0;
+}
+
+void med_free(med_t *m) {
+    if (!m) return;
+    free(m->data);
+    free(m->pos);
+    m->data = NULL;
+    m->pos  = NULL;
+    m->heap = NULL;
+    m->n = m->ct = 0;
+}
+
+void med_push(med_t *m, double x) {
+    int is_new = (m->ct < m->n);
+    int p = m->pos[m->idx];
+    double old = m->data[m->idx];
+    m->data[m->idx] = x;
+    if (++m->idx == m->n) m->idx = 0;
+    m->ct += is_new;
+
+    if (p > 0) {            // case dans le tas min
+        if (!is_new && old < x) min_sort_down(m, p * 2);
+        else if (min_sort_up(m, p)) max_sort_down(m, -1);
+    } else if (p < 0) {     // case dans le tas max
+        if (!is_new && x < old) max_sort_down(m, p * 2);
+        else if (max_sort_up(m, p)) min_sort_down(m, 1);
+    } else {                // case de la médiane: échange avec une racine puis descente
+        if (max_ct(m) && max_sort_up(m, -1)) max_sort_down(m, -2);
+        if (min_ct(m) && min_sort_up(m, 1))  min_sort_down(m, 2);
+    }
+}
+
+double med_value(const med_t *m) {
+    return m->ct ? m->data[m->heap[0]] : 0.0;
+}
+
+double med_at(const med_t *m, int age) {
+    int i = m->idx - 1 - age;
+    while (i < 0) i += m->n;
+    return m->data[i];
+}
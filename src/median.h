@@ -0,0 +1,37 @@
+// src/median.h
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * MEDIAN: médiane glissante en O(log n) par échantillon ("mediator"):
+ * un tas max (moitié basse) et un tas min (moitié haute) accolés autour de
+ * la médiane, indexés par position dans la fenêtre circulaire. Le plus
+ * ancien échantillon est remplacé sur place puis ré-ordonné dans son tas.
+ */
+
+typedef struct {
+    double *data;   // fenêtre circulaire des valeurs
+    int    *pos;    // position de chaque case de data dans heap
+    int    *heap;   // tas max [-n/2..-1] | médiane [0] | tas min [1..n/2]
+    int     n;      // longueur de fenêtre
+    int     idx;    // prochaine case à remplacer
+    int     ct;     // échantillons présents (<= n)
+} med_t;
+
+/** Alloue une fenêtre de n échantillons. Retourne 0 si OK, -1 sinon. */
+int    med_init(med_t *m, int n);
+/** Libère la fenêtre. */
+void   med_free(med_t *m);
+/** Ajoute un échantillon (remplace le plus ancien si la fenêtre est pleine). */
+void   med_push(med_t *m, double x);
+/** Médiane courante (0 si fenêtre vide). */
+double med_value(const med_t *m);
+/** Valeur poussée il y a 'age' échantillons (0 = la plus récente, age < ct). */
+double med_at(const med_t *m, int age);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,25 +1,37 @@
-
 // src/mms.c
 #include "mms.h"
+#include "lat.h"
 #include <stdio.h>
 #include <string.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <time.h>
 #include <errno.h>
+#include <pthread.h>
+#include <semaphore.h>
 
-int mms_send(double value) {
-    int sockfd;
-    struct sockaddr_in addr;
-    char buffer[128];
-    struct timespec ts;
+/* File MPSC bornée (cellules à numéro de séquence): les producteurs se
+ * réservent une case par CAS sur head, le thread émetteur seul avance tail. */
+typedef struct {
+    _Atomic uint32_t seq;
+    mms_event_t      ev;
+} mms_cell_t;
 
-    clock_gettime(CLOCK_REALTIME, &ts);
-    snprintf(buffer, sizeof(buffer),
-             "MMS: value=%.2f ts=%ld.%09ld",
-             value, ts.tv_sec, ts.tv_nsec);
+static mms_cell_t       q_cells[MMS_QUEUE_SZ];
+static _Atomic uint32_t q_head = 0;
+static uint32_t         q_tail = 0;
+static sem_t            q_sem;
 
-    sockfd = socket(AF_INET, SOCK_DGRAM, 0);
+static pthread_t        mms_thread_id;
+static _Atomic int      mms_running = 0;
+static _Atomic uint64_t mms_posted  = 0;
+static _Atomic uint64_t mms_sent    = 0;
+static _Atomic uint64_t mms_dropped = 0;
+static _Atomic uint64_t mms_errors  = 0;
+
+/* Socket UDP multicast configurée (TTL, interface d'envoi) */
+static int mms_socket_open(void) {
+    int sockfd = socket(AF_INET, SOCK_DGRAM, 0);
     if (sockfd < 0) {
         perror("socket");
         return -1;
@@ -38,21 +50,159 @@ int mms_send(double value) {
     if (setsockopt(sockfd, IPPROTO_IP, IP_MULTICAST_IF, &iface, sizeof(iface)) < 0) {
         fprintf(stderr, "[WARN] setsockopt(IP_MULTICAST_IF): %s\n", strerror(errno));
     }
+    return sockfd;
+}
+
+static int mms_sendto(int sockfd, double value) {
+    struct sockaddr_in addr;
+    char buffer[128];
+    struct timespec ts;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    snprintf(buffer, sizeof(buffer),
+             "MMS: value=%.2f ts=%ld.%09ld",
+             value, ts.tv_sec, ts.tv_nsec);
 
     // Adresse de destination = groupe multicast
     memset(&addr, 0, sizeof(addr));
     addr.sin_family = AF_INET;
     addr.sin_port   = htons(MMS_PORT);
     addr.sin_addr.s_addr = inet_addr(MMS_GROUP);
-    // printf("je prerape lenvoie\n");
     int ret = sendto(sockfd, buffer, strlen(buffer), 0, (struct sockaddr *)&addr, sizeof(addr));
-    // printf("jai envoye\n");
     if (ret < 0) {
         fprintf(stderr, "[ERROR] sendto(%s:%d): %s\n", MMS_GROUP, MMS_PORT, strerror(errno));
-        close(sockfd);
         return -1;
     }
+    return 0;
+}
 
+int mms_send(double value) {
+    int sockfd = mms_socket_open();
+    if (sockfd < 0) return -1;
+    int ret = mms_sendto(sockfd, value);
     close(sockfd);
+    return ret;
+}
+
+/* -------------------- File MPSC -------------------- */
+
+int mms_post(double value, int64_t t_sample_ns, mms_src_t src) {
+    if (!atomic_load_explicit(&mms_running, memory_order_acquire)) {
+        atomic_fetch_add_explicit(&mms_dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+    uint32_t pos = atomic_load_explicit(&q_head, memory_order_relaxed);
+    mms_cell_t *cell;
+    for (;;) {
+        cell = &q_cells[pos & (MMS_QUEUE_SZ - 1)];
+        uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q_head, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            atomic_fetch_add_explicit(&mms_dropped, 1, memory_order_relaxed);
+            return -1; // plein: l'émetteur n'a pas encore libéré la case
+        } else {
+            pos = atomic_load_explicit(&q_head, memory_order_relaxed);
+        }
+    }
+    cell->ev = (mms_event_t){ value, t_sample_ns, lat_now_ns(), (int)src };
+    atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+    atomic_fetch_add_explicit(&mms_posted, 1, memory_order_relaxed);
+    sem_post(&q_sem);
+    return 0;
+}
+
+/* Consommateur unique: prochain événement publié, -1 si aucun */
+static int mms_pop(mms_event_t *ev) {
+    mms_cell_t *cell = &q_cells[q_tail & (MMS_QUEUE_SZ - 1)];
+    uint32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    if ((int32_t)(seq - (q_tail + 1)) < 0) return -1;
+    *ev = cell->ev;
+    atomic_store_explicit(&cell->seq, q_tail + MMS_QUEUE_SZ, memory_order_release);
+    q_tail++;
+    return 0;
+}
+
+static void mms_deliver(int *sockfd, const mms_event_t *ev) {
+    if (*sockfd < 0) *sockfd = mms_socket_open(); // nouvel essai à chaque événement
+    if (*sockfd < 0 || mms_sendto(*sockfd, ev->value) != 0) {
+        atomic_fetch_add_explicit(&mms_errors, 1, memory_order_relaxed);
+        return;
+    }
+    atomic_fetch_add_explicit(&mms_sent, 1, memory_order_relaxed);
+    int64_t t_sent = lat_now_ns();
+    if (ev->src == MMS_SRC_FAST) {
+        lat_record(LAT_FAST_MMS, t_sent - ev->t_sample_ns);
+    } else {
+        lat_record(LAT_MMS, t_sent - ev->t_post_ns);
+        if (ev->t_sample_ns) lat_record(LAT_E2E_MMS, t_sent - ev->t_sample_ns);
+    }
+}
+
+static void* mms_thread(void *arg) {
+    (void)arg;
+    int sockfd = -1;
+    for (;;) {
+        while (sem_wait(&q_sem) != 0 && errno == EINTR) { }
+        /* Vidage complet à chaque réveil: le jeton d'un dépôt peut arriver
+         * alors que la case de tête est réservée par l'autre producteur mais
+         * pas encore publiée; ce dernier reposte en publiant, et ce réveil-là
+         * emporte aussi les cases publiées derrière. Jetons en trop: réveil
+         * à vide. */
+        mms_event_t ev;
+        while (mms_pop(&ev) == 0) mms_deliver(&sockfd, &ev);
+        if (!atomic_load_explicit(&mms_running, memory_order_acquire)) break;
+    }
+    if (sockfd >= 0) close(sockfd);
+    return NULL;
+}
+
+/* -------------------- API publique -------------------- */
+
+int mms_start(void) {
+    if (atomic_load(&mms_running)) return 0;
+    for (uint32_t i = 0; i < MMS_QUEUE_SZ; ++i) atomic_store(&q_cells[i].seq, i);
+    atomic_store(&q_head, 0);
+    q_tail = 0;
+    if (sem_init(&q_sem, 0, 0) != 0) {
+        perror("sem_init(mms)");
+        return -1;
+    }
+    atomic_store(&mms_running, 1);
+    int rc = pthread_create(&mms_thread_id, NULL, mms_thread, NULL);
+    if (rc != 0) {
+        fprintf(stderr, "[ERROR] pthread_create(mms): %s\n", strerror(rc));
+        atomic_store(&mms_running, 0);
+        sem_destroy(&q_sem);
+        return -1;
+    }
     return 0;
 }
+
+void mms_stop(void) {
+    if (!atomic_load(&mms_running)) return;
+    atomic_store_explicit(&mms_running, 0, memory_order_release);
+    sem_post(&q_sem);
+    pthread_join(mms_thread_id, NULL);
+    sem_destroy(&q_sem);
+}
+
+void mms_get_stats(mms_stats_t *st) {
+    if (!st) return;
+    st->posted  = atomic_load_explicit(&mms_posted, memory_order_relaxed);
+    st->sent    = atomic_load_explicit(&mms_sent, memory_order_relaxed);
+    st->dropped = atomic_load_explicit(&mms_dropped, memory_order_relaxed);
+    st->errors  = atomic_load_explicit(&mms_errors, memory_order_relaxed);
+}
+
+int mms_build_json(char *buf, size_t sz) {
+    mms_stats_t st;
+    mms_get_stats(&st);
+    return snprintf(buf, sz,
+                    "{\n  \"posted\": %llu,\n  \"sent\": %llu,\n  \"dropped\": %llu,\n"
+                    "  \"errors\": %llu,\n  \"capacity\": %d\n}\n",
+                    (unsigned long long)st.posted, (unsigned long long)st.sent,
+                    (unsigned long long)st.dropped, (unsigned long long)st.errors, MMS_QUEUE_SZ);
+}
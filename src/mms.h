@@ -1,7 +1,8 @@
-
 // src/mms.h
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -9,13 +10,54 @@ extern "C" {
 
 /**
  * MMS-like: envoi d'un message UDP multicast avec timestamp.
+ * - mms_send(): envoi synchrone (socket ouverte et fermée à chaque appel).
+ * - mms_post(): dépôt non bloquant dans une file MPSC bornée sans verrou
+ *   (task_protection et chemin de déclenchement rapide du thread
+ *   d'acquisition); un thread émetteur dédié publie sur une socket
+ *   persistante et mesure les latences de publication (cf. lat.h).
  */
 
 #define MMS_GROUP "239.0.0.1" // Adresse multicast
 #define MMS_PORT  5005        // Port UDP
 
+#define MMS_QUEUE_SZ 64       // doit être une puissance de 2
+
+typedef enum {
+    MMS_SRC_APS = 0,   // décision du cycle de protection (task_protection)
+    MMS_SRC_FAST       // élément rapide du thread d'acquisition (cf. fast.h)
+} mms_src_t;
+
+typedef struct {
+    double  value;
+    int64_t t_sample_ns;   // échantillon à l'origine de l'événement (CLOCK_MONOTONIC), 0 = inconnu
+    int64_t t_post_ns;     // dépôt dans la file
+    int     src;           // mms_src_t
+} mms_event_t;
+
+typedef struct {
+    uint64_t posted;
+    uint64_t sent;
+    uint64_t dropped;      // file pleine
+    uint64_t errors;       // échecs sendto
+} mms_stats_t;
+
 /** Envoie un message MMS avec valeur et timestamp. */
-int MMS_send(double value);
+int  mms_send(double value);
+
+/** Démarre le thread émetteur. Retourne 0 si OK. */
+int  mms_start(void);
+/** Arrête le thread émetteur (événements restants publiés). */
+void mms_stop(void);
+/**
+ * Dépose un événement (non bloquant, multi-producteurs). t_sample_ns = instant
+ * de l'échantillon déclencheur. Retourne 0 si OK, -1 si file pleine ou
+ * émetteur arrêté (événement compté perdu).
+ */
+int  mms_post(double value, int64_t t_sample_ns, mms_src_t src);
+/** Compteurs de la file et du thread émetteur. */
+void mms_get_stats(mms_stats_t *st);
+/** Compteurs en JSON (GET /mms). Retourne la longueur écrite. */
+int  mms_build_json(char *buf, size_t sz);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,248 @@
+// src/prot.c
+#include "prot.h"
+#include "config.h"
+#include <string.h>
+#include <math.h>
+
+int prot_init(prot_t *p, int nch, int fs_hz) {
+    memset(p, 0, sizeof(*p));
+    if (nch <= 0 || nch > BEA_MAX_CH) return -1;
+    p->nch = nch;
+    p->fs_hz = fs_hz;
+    prot_cfg_t cfg;
+    if (prot_config_load(&cfg, p) != 0) return -1;
+    prot_apply_config(p, &cfg);
+    prot_config_release(&cfg);
+    return 0;
+}
+
+/* Élément à temps constant ou inverse selon la courbe configurée */
+static void prot_add_stage(elem_table_t *t, elem_kind_t kind, int c, int src, double pickup,
+                           int curve, double td, int delay_ms) {
+    if (curve != BOM_CURVE_DEFINITE) elem_add_inverse(t, kind, c, src, pickup, (bom_curve_t)curve, td);
+    else elem_add_definite(t, kind, c, src, pickup, delay_ms);
+}
+
+int prot_config_load(prot_cfg_t *cfg, const prot_t *p) {
+    memset(cfg, 0, sizeof(*cfg));
+    int fs = p->fs_hz > 0 ? p->fs_hz : config_get_sample_rate_hz();
+
+    /* Filtre: fenêtre bornée à un quart de période réseau (sinon la médiane
+     * déforme l'onde et le test d'écart rejette des échantillons sains) */
+    int win = config_get_filter_window();
+    int win_max = (int)((double)fs / (4.0 * config_get_nominal_freq_hz()));
+    if (win > win_max) win = win_max;
+    if (win < 1) win = 1;
+    if (!(win & 1)) win--;
+    cfg->filt_win    = win;
+    cfg->outlier_tol = config_get_outlier_tol();
+    cfg->max_loss    = config_get_max_loss_ratio();
+
+    // Banc harmonique: fenêtre de harm_cycles périodes réseau
+    if (harm_init(&cfg->harm, fs, config_get_nominal_freq_hz(), config_get_harm_cycles()) != 0) {
+        memset(&cfg->harm, 0, sizeof(cfg->harm)); // cadence < 2*f0: pas d'analyse harmonique
+    }
+
+    /* Fenêtres allouées ici seulement si leur longueur change */
+    int n = config_get_samples();
+    for (int c = 0; c < p->nch; ++c) {
+        if ((!p->rmsA[c].buf || p->rmsA[c].window != n) &&
+            (rms_init(&cfg->rmsA[c], n) != 0 || rms_init(&cfg->rmsV[c], n) != 0)) goto fail;
+        if (win != p->filt_win &&
+            (med_init(&cfg->medA[c], win) != 0 || med_init(&cfg->medV[c], win) != 0)) goto fail;
+    }
+
+    /* Courbes de temporisation (noms validés au chargement de la config) */
+    cfg->curve_A = bom_curve_from_name(config_get_curve_A());
+    cfg->curve_V = bom_curve_from_name(config_get_curve_V());
+    if (cfg->curve_A < 0) cfg->curve_A = BOM_CURVE_DEFINITE;
+    if (cfg->curve_V < 0) cfg->curve_V = BOM_CURVE_DEFINITE;
+    cfg->thr_A     = config_get_threshold_A();
+    cfg->thr_V     = config_get_threshold_V();
+    cfg->td_A      = config_get_time_dial_A();
+    cfg->td_V      = config_get_time_dial_V();
+    cfg->tms_A_ms  = config_get_tms_A_ms();
+    cfg->tms_V_ms  = config_get_tms_V_ms();
+    cfg->ioc_A     = config_get_ioc_pickup_A();
+    cfg->ioc_ms    = config_get_ioc_delay_ms();
+    cfg->uv_V      = config_get_uv_pickup_V();
+    cfg->uv_ms     = config_get_uv_delay_ms();
+
+    /* Logique de déclenchement (validée au chargement de la config) */
+    if (logic_compile(&cfg->logic, config_get_trip_logic(), NULL, 0) != 0) logic_compile(&cfg->logic, "any", NULL, 0);
+    return 0;
+
+fail:
+    prot_config_release(cfg);
+    return -1;
+}
+
+void prot_config_release(prot_cfg_t *cfg) {
+    for (int c = 0; c < BEA_MAX_CH; ++c) {
+        rms_free(&cfg->rmsA[c]);
+        rms_free(&cfg->rmsV[c]);
+        med_free(&cfg->medA[c]);
+        med_free(&cfg->medV[c]);
+    }
+}
+
+/* Échange de deux fenêtres (la nouvelle entre, l'ancienne part dans cfg) */
+#define PROT_SWAP(T, a, b) do { T tmp_ = (a); (a) = (b); (b) = tmp_; } while (0)
+
+void prot_apply_config(prot_t *p, prot_cfg_t *cfg) {
+    p->outlier_tol = cfg->outlier_tol;
+    p->max_loss    = cfg->max_loss;
+
+    for (int c = 0; c < p->nch; ++c) {
+        // Résultat harmonique gardé si la fenêtre est inchangée
+        if (cfg->harm.n_win != p->harmA[c].n_win || cfg->harm.nh != p->harmA[c].nh) {
+            p->harmA[c] = cfg->harm;
+            p->harmV[c] = cfg->harm;
+        }
+        if (cfg->rmsA[c].buf) {
+            PROT_SWAP(rms_stream_t, p->rmsA[c], cfg->rmsA[c]);
+            PROT_SWAP(rms_stream_t, p->rmsV[c], cfg->rmsV[c]);
+        }
+        if (cfg->medA[c].data) {
+            PROT_SWAP(med_t, p->medA[c], cfg->medA[c]);
+            PROT_SWAP(med_t, p->medV[c], cfg->medV[c]);
+            p->lost[c] = 0;
+        }
+    }
+    p->filt_win = cfg->filt_win;
+
+    /* Table d'éléments reconstruite; accumulateurs et temporisations en cours
+     * repris pour les éléments conservés (type, voie, entrée) */
+    elem_table_t *t = &p->elems;
+    elem_state_t st;
+    elem_save_state(t, &st);
+    elem_clear(t);
+    for (int c = 0; c < p->nch; ++c) {
+        prot_add_stage(t, ELEM_TOC, c, ELEM_SRC_A(c), cfg->thr_A, cfg->curve_A, cfg->td_A, cfg->tms_A_ms);
+        prot_add_stage(t, ELEM_OV, c, ELEM_SRC_V(c), cfg->thr_V, cfg->curve_V, cfg->td_V, cfg->tms_V_ms);
+        if (cfg->ioc_A > 0.0) elem_add_definite(t, ELEM_IOC, c, ELEM_SRC_A(c), cfg->ioc_A, cfg->ioc_ms);
+        if (cfg->uv_V > 0.0)  elem_add_definite(t, ELEM_UV, c, ELEM_SRC_V(c), cfg->uv_V, cfg->uv_ms);
+    }
+    elem_restore_state(t, &st);
+
+    /* Temporisations de la logique remises à zéro seulement si le programme change */
+    if (memcmp(&cfg->logic, &p->logic, sizeof(cfg->logic)) != 0) {
+        p->logic = cfg->logic;
+        for (int c = 0; c < p->nch; ++c) logic_reset(&p->logic_st[c]);
+    }
+}
+
+void prot_free(prot_t *p) {
+    for (int c = 0; c < p->nch; ++c) {
+        rms_free(&p->rmsA[c]);
+        rms_free(&p->rmsV[c]);
+        med_free(&p->medA[c]);
+        med_free(&p->medV[c]);
+    }
+}
+
+/* x s'écarte-t-il de la médiane de plus de outlier_tol x max(RMS, |médiane|) ? */
+static int prot_outlier(const prot_t *p, const rms_stream_t *r, const med_t *m, double x) {
+    double med = med_value(m);
+    double ref = fmax(rms_value(r), fabs(med));
+    return p->outlier_tol > 0.0 && ref > 0.0 && fabs(x - med) > p->outlier_tol * ref;
+}
+
+/* Valeur entrée à la place d'un timeout: la dernière valeur entrée (pas de
+ * rebouclage de la médiane sur elle-même pendant une rafale de timeouts),
+ * ou la médiane si cette dernière était aberrante (pas de pic dupliqué). */
+static double prot_hold(const prot_t *p, const rms_stream_t *r, const med_t *m) {
+    if (m->ct == 0) return 0.0;
+    double last = med_at(m, 0);
+    return prot_outlier(p, r, m, last) ? med_value(m) : last;
+}
+
+/* Filtre d'une voie: fait entrer l'échantillon (timeout marqué perdu) et
+ * statue sur l'échantillon central de la fenêtre. */
+static void prot_filter(prot_t *p, int c, double a, double v, int ok) {
+    med_t *ma = &p->medA[c], *mv = &p->medV[c];
+    const int h = p->filt_win / 2;
+
+    if (!ok) {
+        a = prot_hold(p, &p->rmsA[c], ma);
+        v = prot_hold(p, &p->rmsV[c], mv);
+    }
+    med_push(ma, a);
+    med_push(mv, v);
+    p->lost[c] = (p->lost[c] << 1) | (uint32_t)!ok;
+    if (ma->ct <= h) return; // échantillon central pas encore disponible
+
+    double ca = med_at(ma, h), cv = med_at(mv, h);
+    int reject = ((p->lost[c] >> h) & 1u) ||
+                 (h > 0 && (prot_outlier(p, &p->rmsA[c], ma, ca) ||
+                            prot_outlier(p, &p->rmsV[c], mv, cv)));
+    if (reject) {
+        p->n_rej[c]++;
+        harm_push(&p->harmA[c], med_value(ma));
+        harm_push(&p->harmV[c], med_value(mv));
+        return;
+    }
+    rms_push(&p->rmsA[c], ca);
+    rms_push(&p->rmsV[c], cv);
+    harm_push(&p->harmA[c], ca);
+    harm_push(&p->harmV[c], cv);
+}
+
+void prot_push(prot_t *p, const bea_block_t *blk) {
+    p->n_new++;
+    for (int c = 0; c < p->nch; ++c) {
+        prot_filter(p, c, blk->current_A[c], blk->voltage_V[c], blk->status[c] >= 0);
+    }
+}
+
+void prot_eval(prot_t *p, const struct timespec *now, prot_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->nch = p->nch;
+
+    /* Invalidité par voie: trop de rejets ou aucun échantillon nouveau sur le cycle */
+    for (int c = 0; c < p->nch; ++c) {
+        out->loss[c] = p->n_new ? (double)p->n_rej[c] / (double)p->n_new : 1.0;
+        if (out->loss[c] > 1.0) out->loss[c] = 1.0;
+        int err = (p->n_new == 0 || out->loss[c] > p->max_loss);
+        p->n_rej[c] = 0;
+        out->rmsA[c] = err ? -1.0 : rms_value(&p->rmsA[c]);
+        out->rmsV[c] = err ? -1.0 : rms_value(&p->rmsV[c]);
+        out->ch_valid[c] = (out->rmsA[c] >= 0 && out->rmsV[c] >= 0);
+        if (out->ch_valid[c]) rms_stats(&p->rmsA[c], &out->statA[c]);
+        out->harmA[c] = p->harmA[c].last;
+        out->harmV[c] = p->harmV[c].last;
+        if (out->ch_valid[c]) out->valid = 1;
+    }
+    p->n_new = 0;
+
+    /* Toute la table en une passe, un seul instant pour le cycle */
+    double in[ELEM_INPUTS] = {0}, ok[ELEM_INPUTS] = {0};
+    for (int c = 0; c < p->nch; ++c) {
+        in[ELEM_SRC_A(c)] = out->rmsA[c];
+        in[ELEM_SRC_V(c)] = out->rmsV[c];
+        ok[ELEM_SRC_A(c)] = ok[ELEM_SRC_V(c)] = out->ch_valid[c] ? 1.0 : 0.0;
+    }
+    double dt = 0.0;
+    if (p->have_last) {
+        dt = (double)(now->tv_sec - p->last.tv_sec) + (double)(now->tv_nsec - p->last.tv_nsec) / 1e9;
+    }
+    p->last = *now;
+    p->have_last = 1;
+    elem_eval(&p->elems, in, ok, dt);
+
+    /* Éléments déclenchés, par voie */
+    const elem_table_t *t = &p->elems;
+    for (int i = 0; i < t->n; ++i) {
+        if (!t->trip[i]) continue;
+        int c = t->ch[i];
+        if (t->kind[i] == ELEM_IOC || t->kind[i] == ELEM_TOC) out->tripA[c] = 1;
+        else out->tripV[c] = 1;
+        out->kinds[c] |= 1u << t->kind[i];
+    }
+
+    /* Logique de déclenchement compilée, par voie */
+    for (int c = 0; c < p->nch; ++c) {
+        out->ch_trip[c] = logic_eval(&p->logic, &p->logic_st[c], out->kinds[c], dt);
+        if (out->ch_trip[c]) out->trip = 1;
+    }
+}
@@ -0,0 +1,135 @@
+// src/prot.h
+#pragma once
+#include <time.h>
+#include "bea.h"
+#include "rms.h"
+#include "stats.h"
+#include "harm.h"
+#include "median.h"
+#include "elem.h"
+#include "logic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * PROT: chaîne de protection commune au temps réel (task_protection) et au
+ * rejeu hors ligne (outil replay):
+ *   échantillons A/V -> filtre médian (timeouts, aberrants)
+ *   -> fenêtres RMS glissantes + banc harmonique (Goertzel)
+ *   -> invalidité -> table d'éléments (50/51/27/59, temps constant ou inverse)
+ *   -> logique de déclenchement (trip_logic compilée, par voie, cf. logic.h).
+ * L'instant d'évaluation est fourni par l'appelant: CLOCK_MONOTONIC en temps
+ * réel, horodatage enregistré en rejeu (plus rapide que le temps réel).
+ *
+ * Multi-départs: un jeu RMS par voie, rangé en tableaux par grandeur; les
+ * éléments de toutes les voies sont dans une seule table évaluée en une
+ * passe par cycle (cf. elem.h): 51 (threshold_A, curve_A) et 59
+ * (threshold_V, curve_V) sur chaque voie, 50 et 27 si leur seuil est réglé.
+ * Une voie invalide n'empêche pas les autres de protéger.
+ *
+ * Filtre (par voie, fenêtre impaire filter_window, médiane glissante O(log n)):
+ * l'échantillon central de la fenêtre est rejeté s'il provient d'un timeout
+ * ou s'il s'écarte de la médiane de plus de outlier_tol x max(RMS, |médiane|)
+ * en courant ou en tension. Le RMS ne porte que sur les échantillons
+ * retenus; le banc harmonique reçoit la médiane à la place d'un rejet (pas
+ * de trou de fenêtre). Un échelon durable passe après filter_window/2
+ * échantillons; une salve plus courte est rejetée. La voie n'est invalide
+ * que si la part de rejets du cycle dépasse max_loss_ratio.
+ * La fenêtre doit rester courte devant la période réseau: elle est réduite
+ * à fs / (4 f0) (1 = timeouts seuls, sans test d'écart) aux cadences basses.
+ */
+
+typedef struct {
+    int   nch;
+    rms_stream_t rmsA[BEA_MAX_CH];  // fenêtres RMS glissantes courant
+    rms_stream_t rmsV[BEA_MAX_CH];  // fenêtres RMS glissantes tension
+    elem_table_t elems;             // éléments de protection de toutes les voies
+    struct timespec last;           // instant de la dernière évaluation
+    int   have_last;
+    logic_prog_t  logic;                   // trip_logic compilée
+    logic_state_t logic_st[BEA_MAX_CH];    // temporisations de la logique, par voie
+    harm_bank_t harmA[BEA_MAX_CH];  // harmoniques courant (rangs 1..13, THD)
+    harm_bank_t harmV[BEA_MAX_CH];  // harmoniques tension
+    med_t medA[BEA_MAX_CH];         // médianes glissantes du filtre courant
+    med_t medV[BEA_MAX_CH];         // médianes glissantes du filtre tension
+    uint32_t lost[BEA_MAX_CH];      // bit k = échantillon d'âge k issu d'un timeout
+    int   filt_win;                 // fenêtre effective du filtre (impaire)
+    double outlier_tol;
+    double max_loss;
+    int   n_new;                    // échantillons reçus depuis la dernière évaluation
+    int   n_rej[BEA_MAX_CH];        // dont rejetés (timeout, aberrant), par voie
+    int   fs_hz;                    // cadence imposée (rejeu), 0 = config sample_rate_hz
+} prot_t;
+
+typedef struct {
+    int    nch;
+    int    valid;                   // 0 = aucune voie valide sur le cycle (aucune décision)
+    int    ch_valid[BEA_MAX_CH];
+    double loss[BEA_MAX_CH];        // part d'échantillons rejetés sur le cycle (0..1)
+    double rmsA[BEA_MAX_CH];        // -1 si voie invalide
+    double rmsV[BEA_MAX_CH];
+    int    tripA[BEA_MAX_CH];       // élément 50 ou 51 déclenché
+    int    tripV[BEA_MAX_CH];       // élément 27 ou 59 déclenché
+    unsigned kinds[BEA_MAX_CH];     // éléments déclenchés (bit 1 << elem_kind_t)
+    int    ch_trip[BEA_MAX_CH];     // décision par voie (trip_logic)
+    stats_block_t statA[BEA_MAX_CH]; // fenêtre courant: DC, min/max, crête (saturation, distorsion)
+    harm_result_t harmA[BEA_MAX_CH]; // dernière fenêtre harmonique courant (H2: appel de courant)
+    harm_result_t harmV[BEA_MAX_CH]; // dernière fenêtre harmonique tension (THD: distorsion)
+    int    trip;                    // décision finale (au moins une voie)
+} prot_result_t;
+
+/**
+ * Réglages de la chaîne, relevés dans la config hors temps réel: le cycle RT
+ * n'appelle ni config_get_* (chaînes réécrites par config_load) ni malloc.
+ * Les fenêtres dont la longueur change sont allouées ici (buf/data NULL =
+ * inchangée); après prot_apply_config, cfg contient les anciennes.
+ */
+typedef struct {
+    int    filt_win;                // fenêtre effective du filtre (impaire)
+    double outlier_tol;
+    double max_loss;
+    harm_bank_t  harm;              // banc harmonique initialisé (n_win 0 = aucun)
+    rms_stream_t rmsA[BEA_MAX_CH];
+    rms_stream_t rmsV[BEA_MAX_CH];
+    med_t  medA[BEA_MAX_CH];
+    med_t  medV[BEA_MAX_CH];
+    int    curve_A, curve_V;        // bom_curve_t
+    double thr_A, thr_V;
+    double td_A, td_V;
+    int    tms_A_ms, tms_V_ms;
+    double ioc_A, uv_V;             // 0 = élément 50 / 27 absent
+    int    ioc_ms, uv_ms;
+    logic_prog_t logic;             // trip_logic compilée
+} prot_cfg_t;
+
+/**
+ * Alloue les fenêtres de nch voies et charge seuils/TMS depuis la config.
+ * fs_hz: cadence des échantillons (0 = config sample_rate_hz). Retourne 0 si OK.
+ */
+int  prot_init(prot_t *p, int nch, int fs_hz);
+/**
+ * Relève la config pour p (hors temps réel, p non modifié pendant l'appel).
+ * Retourne 0 si OK, -1 si allocation impossible (rien n'est à appliquer).
+ */
+int  prot_config_load(prot_cfg_t *cfg, const prot_t *p);
+/**
+ * Applique un relevé (thread de p, sans allocation ni E/S). Les
+ * accumulateurs des éléments conservés et les temporisations de trip_logic
+ * (si inchangée) sont repris: un rechargement ne remet pas à zéro une surcharge
+ * en cours.
+ */
+void prot_apply_config(prot_t *p, prot_cfg_t *cfg);
+/** Libère les fenêtres restant dans cfg (remplacées ou non appliquées). */
+void prot_config_release(prot_cfg_t *cfg);
+/** Libère les fenêtres. */
+void prot_free(prot_t *p);
+/** Ajoute une mesure multi-voies (status[c] <0 = voie invalide). */
+void prot_push(prot_t *p, const bea_block_t *blk);
+/** Évalue le cycle à l'instant 'now' et remet à zéro les compteurs du cycle. */
+void prot_eval(prot_t *p, const struct timespec *now, prot_result_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,193 @@
+// src/replay_main.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cap.h"
+#include "prot.h"
+#include "fast.h"
+#include "config.h"
+
+/**
+ * Outil de rejeu hors ligne: évalue la chaîne de protection (prot.c, la même
+ * que task_protection) sur une capture CAP, à pleine vitesse CPU.
+ * - Les décisions BOM utilisent les horodatages enregistrés, pas l'horloge murale.
+ * - Une évaluation tous les 'periode_ms' de temps enregistré (100 ms = cycle APS).
+ * - L'élément 50 HS instantané (fast.c) voit chaque enregistrement, comme le
+ *   thread d'acquisition: son front est daté de l'échantillon, et il maintient
+ *   l'état TRIP aux évaluations tant qu'il n'est pas retombé.
+ * Sortie: chronologie des changements d'état (NORMAL / TRIP / INVALID) + synthèse.
+ *
+ * Usage: replay <capture.cap> [config.json] [periode_ms]
+ *        replay --check   (contrôles intégrés, sans capture; code 1 si échec)
+ */
+
+#define REPLAY_PERIOD_MS_DEFAULT 100
+
+typedef enum { ST_UNKNOWN = -1, ST_NORMAL = 0, ST_TRIP = 1, ST_INVALID = 2 } replay_state_t;
+
+static const char *state_name(replay_state_t s) {
+    switch (s) {
+    case ST_NORMAL:  return "NORMAL";
+    case ST_TRIP:    return "TRIP";
+    case ST_INVALID: return "INVALID";
+    default:         return "?";
+    }
+}
+
+static struct timespec ns_to_ts(int64_t ns) {
+    struct timespec ts = { .tv_sec = (time_t)(ns / 1000000000LL), .tv_nsec = (long)(ns % 1000000000LL) };
+    return ts;
+}
+
+/* Contrôle intégré: élément à temps constant sollicité à t = 0 sur une grille
+ * exacte de cycles (dt calculé comme prot_eval). Le déclenchement doit tomber
+ * au cycle délai/période, pas un cycle plus tard par cumul d'arrondis. */
+static int replay_check(void) {
+    static const int periods_ms[] = { 10, 20, 100 };
+    static const int delays_ms[]  = { 100, 1000, 1500, 3000, 600000 };
+    static elem_table_t t;
+    int fails = 0;
+
+    for (size_t ip = 0; ip < sizeof(periods_ms) / sizeof(periods_ms[0]); ++ip) {
+        for (size_t id = 0; id < sizeof(delays_ms) / sizeof(delays_ms[0]); ++id) {
+            const int p = periods_ms[ip], d = delays_ms[id];
+            double in[ELEM_INPUTS] = {0}, ok[ELEM_INPUTS] = {0};
+            in[ELEM_SRC_A(0)] = 2.0;
+            ok[ELEM_SRC_A(0)] = 1.0;
+            elem_clear(&t);
+            elem_add_definite(&t, ELEM_TOC, 0, ELEM_SRC_A(0), 1.0, d);
+
+            const long expect = d / p;
+            long k, trip_k = -1;
+            struct timespec last = {0};
+            for (k = 0; k <= expect + 2 && trip_k < 0; ++k) {
+                struct timespec now = ns_to_ts((int64_t)k * p * 1000000LL);
+                double dt = k ? (double)(now.tv_sec - last.tv_sec) + (double)(now.tv_nsec - last.tv_nsec) / 1e9 : 0.0;
+                last = now;
+                elem_eval(&t, in, ok, dt);
+                if (t.trip[0]) trip_k = k;
+            }
+            int good = (trip_k == expect);
+            if (!good) fails++;
+            printf("  temps constant %6d ms, cycle %3d ms: déclenchement à %8.3f s (attendu %8.3f s)%s\n",
+                   d, p, trip_k < 0 ? -1.0 : trip_k * p / 1000.0, expect * p / 1000.0, good ? "" : "  ÉCHEC");
+        }
+    }
+    printf("# contrôles: %s\n", fails ? "ÉCHEC" : "OK");
+    return fails ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc == 2 && strcmp(argv[1], "--check") == 0) return replay_check();
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <capture.cap> [config.json] [periode_ms]\n", argv[0]);
+        return 2;
+    }
+    const char *cfg = (argc > 2) ? argv[2] : "config.json";
+    int period_ms   = (argc > 3) ? atoi(argv[3]) : REPLAY_PERIOD_MS_DEFAULT;
+    if (period_ms <= 0) period_ms = REPLAY_PERIOD_MS_DEFAULT;
+
+    if (config_load(cfg) != 0) {
+        fprintf(stderr, "[WARN] %s absent ou invalide: valeurs par défaut.\n", cfg);
+    }
+
+    cap_reader_t cap;
+    if (cap_reader_open(&cap, argv[1]) != 0) return 1;
+    if (cap.count == 0) {
+        fprintf(stderr, "[ERROR] Capture vide.\n");
+        cap_reader_close(&cap);
+        return 1;
+    }
+
+    prot_t prot;
+    /* Cadence de la capture (pas celle de la config) pour l'analyse harmonique */
+    if (prot_init(&prot, cap.nch, (int)cap.hdr->sample_rate_hz) != 0) {
+        fprintf(stderr, "[ERROR] Allocation fenêtres RMS impossible.\n");
+        cap_reader_close(&cap);
+        return 1;
+    }
+
+    /* 50 HS: mêmes réglages que le temps réel, à la cadence de la capture */
+    fast_t fast;
+    fast_init(&fast);
+    fast_configure(&fast, config_get_fast_pickup_A(), config_get_fast_count(),
+                   (int)cap.hdr->sample_rate_hz, config_get_nominal_freq_hz());
+
+    struct timespec w0, w1;
+    clock_gettime(CLOCK_MONOTONIC, &w0);
+
+    const int64_t period_ns = (int64_t)period_ms * 1000000LL;
+    const int64_t t0 = cap_reader_record(&cap, 0)->t_ns;
+    int64_t next = t0 + period_ns;
+    replay_state_t state = ST_UNKNOWN;
+    unsigned long cycles = 0, trips = 0, fast_trips = 0, invalid = 0;
+    double loss_sum = 0.0;  // parts de rejets cumulées (toutes voies)
+    prot_result_t res;
+
+    printf("# %zu voie(s)\n# t_s        etat     voie  rmsA        rmsV\n", (size_t)cap.nch);
+    if (config_get_fast_pickup_A() > 0.0)
+        printf("# voie 50HS: front de l'élément instantané, rmsA = crête |i| (A)\n");
+    for (size_t i = 0; i <= cap.count; ++i) {
+        /* i == count: dernière évaluation en fin de capture */
+        const cap_record_t *r = (i < cap.count) ? cap_reader_record(&cap, i) : NULL;
+        int64_t t = r ? r->t_ns : next;
+        while (t >= next) {
+            struct timespec now = ns_to_ts(next);
+            prot_eval(&prot, &now, &res);
+            cycles++;
+            for (int c = 0; c < res.nch; ++c) loss_sum += res.loss[c];
+
+            replay_state_t st = !res.valid ? ST_INVALID : ((res.trip || fast_active(&fast)) ? ST_TRIP : ST_NORMAL);
+            if (st == ST_INVALID) invalid++;
+            if (st != state) {
+                if (st == ST_TRIP) trips++;
+                /* voie affichée: première déclenchée, sinon voie 0 */
+                int c = 0;
+                while (c < res.nch - 1 && !res.ch_trip[c]) c++;
+                if (!res.ch_trip[c]) c = 0;
+                printf("%10.3f  %-7s  %4d  %10.3f  %10.3f\n",
+                       (double)(next - t0) / 1e9, state_name(st), c, res.rmsA[c], res.rmsV[c]);
+                state = st;
+            }
+            next += period_ns;
+        }
+        if (r) {
+            bea_block_t blk;
+            blk.nch = cap.nch;
+            for (int c = 0; c < cap.nch; ++c) {
+                blk.status[c]    = cap_record_status(r, c);
+                blk.current_A[c] = r->ch[c].current_A;
+                blk.voltage_V[c] = r->ch[c].voltage_V;
+            }
+            prot_push(&prot, &blk);
+
+            /* Front 50 HS: sortie immédiate en temps réel, sans attendre le cycle */
+            double peak;
+            if (fast_push(&fast, &blk, &peak)) {
+                fast_trips++;
+                if (state != ST_TRIP) {
+                    trips++;
+                    printf("%10.3f  %-7s  50HS  %10.3f\n", (double)(r->t_ns - t0) / 1e9, state_name(ST_TRIP), peak);
+                    state = ST_TRIP;
+                }
+            }
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &w1);
+    double wall_s = (double)(w1.tv_sec - w0.tv_sec) + (double)(w1.tv_nsec - w0.tv_nsec) / 1e9;
+    double rec_s  = (double)(cap_reader_record(&cap, cap.count - 1)->t_ns - t0) / 1e9;
+
+    printf("# échantillons=%zu durée=%.3f s cycles=%lu déclenchements=%lu (fronts 50HS=%lu) invalides=%lu rejets=%.2f%%\n",
+           cap.count, rec_s, cycles, trips, fast_trips, invalid,
+           cycles ? 100.0 * loss_sum / ((double)cycles * cap.nch) : 0.0);
+    printf("# temps CPU=%.3f s (x%.0f temps réel)\n",
+           wall_s, wall_s > 0.0 ? rec_s / wall_s : 0.0);
+
+    prot_free(&prot);
+    cap_reader_close(&cap);
+    return 0;
+}
@@ -0,0 +1,74 @@
+// src/rms.c
+#include "rms.h"
+#include <stdlib.h>
+#include <math.h>
+
+int rms_init(rms_stream_t *r, int window) {
+    if (!r || window <= 0) return -1;
+    r->buf = (double*)calloc((size_t)window, sizeof(double));
+    if (!r->buf) return -1;
+    r->window = window;
+    rms_reset(r);
+    return 0;
+}
+
+void rms_free(rms_stream_t *r) {
+    if (!r) return;
+    free(r->buf);
+    r->buf = NULL;
+    r->window = 0;
+    r->count = 0;
+}
+
+int rms_resize(rms_stream_t *r, int window) {
+    if (!r || window <= 0) return -1;
+    if (r->buf && r->window == window) return 0;
+    double *nb = (double*)calloc((size_t)window, sizeof(double));
+    if (!nb) return -1; // on garde l'ancienne fenêtre
+    free(r->buf);
+    r->buf = nb;
+    r->window = window;
+    rms_reset(r);
+    return 0;
+}
+
+void rms_reset(rms_stream_t *r) {
+    r->head    = 0;
+    r->count   = 0;
+    r->sumsq   = 0.0;
+    r->fresh   = 0.0;
+    r->epoch_n = 0;
+}
+
+void rms_push(rms_stream_t *r, double x) {
+    double sq = x * x;
+    if (r->count == r->window) {
+        double old = r->buf[r->head];
+        r->sumsq -= old * old;
+    } else {
+        r->count++;
+    }
+    r->buf[r->head] = x;
+    if (++r->head == r->window) r->head = 0;
+    r->sumsq += sq;
+
+    // Re-sommation étalée: après 'window' ajouts, 'fresh' couvre exactement la fenêtre
+    r->fresh += sq;
+    if (++r->epoch_n == r->window) {
+        r->sumsq   = r->fresh;
+        r->fresh   = 0.0;
+        r->epoch_n = 0;
+    }
+}
+
+// L'ordre des échantillons est indifférent: la fenêtre circulaire est passée telle quelle.
+int rms_stats(const rms_stream_t *r, stats_block_t *out) {
+    if (!r || r->count <= 0) return -1;
+    return stats_block_f64(r->buf, (size_t)r->count, out);
+}
+
+double rms_value(const rms_stream_t *r) {
+    if (!r || r->count <= 0) return -1.0;
+    double s = r->sumsq > 0.0 ? r->sumsq : 0.0; // annulation numérique possible
+    return sqrt(s / (double)r->count);
+}
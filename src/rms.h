@@ -0,0 +1,48 @@
+// src/rms.h
+#pragma once
+#include <stddef.h>
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * RMS glissant: somme des carrés courante sur une fenêtre de longueur
+ * quelconque, mise à jour en O(1) par échantillon.
+ *
+ * Dérive flottante: en parallèle de la somme glissante (ajout/retrait), on
+ * accumule une somme "fraîche" depuis le début de l'époque courante. Après
+ * 'window' échantillons, la fenêtre est entièrement renouvelée: la somme
+ * fraîche est alors exacte et remplace la somme glissante. La re-sommation
+ * est donc étalée (toujours O(1)) et l'erreur ne dépasse jamais une fenêtre.
+ */
+
+typedef struct {
+    double *buf;     // valeurs brutes de la fenêtre (circulaire)
+    int    window;   // longueur de fenêtre (échantillons)
+    int    head;     // prochaine case à écrire
+    int    count;    // échantillons présents (<= window)
+    double sumsq;    // somme glissante des carrés
+    double fresh;    // somme des carrés depuis le début de l'époque
+    int    epoch_n;  // échantillons depuis le début de l'époque
+} rms_stream_t;
+
+/** Alloue la fenêtre. Retourne 0 si OK, -1 si window invalide/allocation impossible. */
+int    rms_init(rms_stream_t *r, int window);
+/** Libère la fenêtre. */
+void   rms_free(rms_stream_t *r);
+/** Change la longueur de fenêtre (vide l'historique si elle change). */
+int    rms_resize(rms_stream_t *r, int window);
+/** Vide la fenêtre sans la libérer. */
+void   rms_reset(rms_stream_t *r);
+/** Ajoute un échantillon (retire le plus ancien si la fenêtre est pleine). */
+void   rms_push(rms_stream_t *r, double x);
+/** RMS courant sur les échantillons présents (-1 si fenêtre vide). */
+double rms_value(const rms_stream_t *r);
+/** Statistiques complètes de la fenêtre (une passe, SIMD). Retourne 0 si OK, -1 si vide. */
+int    rms_stats(const rms_stream_t *r, stats_block_t *out);
+
+#ifdef __cplusplus
+}
+#endif
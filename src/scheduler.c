@@ -1,69 +1,567 @@
-
 // src/scheduler.c
-#define _POSIX_C_SOURCE 200809L
+#define _GNU_SOURCE      /* pthread_setaffinity_np, CPU_SET */
 
 #include "scheduler.h"
+#include <stdio.h>
 #include <string.h>
-#include <unistd.h>
+#include <strings.h>
+#include <errno.h>
 #include <time.h>
+#include <sched.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+static const char *class_names[APS_CLASS_COUNT] = { "RT", "NRT" };
+static const char *crit_names[] = { "HI", "MID", "LO" };
+
+static int64_t ts_to_ns(const struct timespec *ts) {
+    return (int64_t)ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts_to_ns(&ts);
+}
+
+/* Instant de l'activation k de la grille courante (jamais cumulé: pas de dérive) */
+static int64_t release_of(const aps_task_t *t, uint64_t k) {
+    uint32_t period_ms = atomic_load_explicit(&t->period_ms, memory_order_relaxed);
+    return t->base_ns + (int64_t)k * (int64_t)period_ms * 1000000LL;
+}
+
+/* -------------------- Tas min des activations -------------------- */
+
+static int heap_less(const aps_scheduler_t *sch, int a, int b) {
+    const aps_task_t *ta = &sch->tasks[a], *tb = &sch->tasks[b];
+    if (ta->release_ns != tb->release_ns) return ta->release_ns < tb->release_ns;
+    return a < b; // échéance égale: ordre d'ajout
+}
+
+static void heap_up(aps_runq_t *rq, int i) {
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (!heap_less(rq->sch, rq->heap[i], rq->heap[parent])) break;
+        uint8_t tmp = rq->heap[i]; rq->heap[i] = rq->heap[parent]; rq->heap[parent] = tmp;
+        i = parent;
+    }
+}
+
+static void heap_down(aps_runq_t *rq, int i) {
+    for (;;) {
+        int l = 2 * i + 1, r = l + 1, m = i;
+        if (l < rq->n && heap_less(rq->sch, rq->heap[l], rq->heap[m])) m = l;
+        if (r < rq->n && heap_less(rq->sch, rq->heap[r], rq->heap[m])) m = r;
+        if (m == i) break;
+        uint8_t tmp = rq->heap[i]; rq->heap[i] = rq->heap[m]; rq->heap[m] = tmp;
+        i = m;
+    }
+}
+
+/* -------------------- Statistiques (seqlock) -------------------- */
+
+static int hist_bin(int64_t ns) {
+    uint64_t us = ns > 0 ? (uint64_t)ns / 1000u : 0;
+    if (us == 0) return 0;
+    int b = 64 - __builtin_clzll(us); // us dans [2^(b-1), 2^b)
+    return b < APS_HIST_BINS ? b : APS_HIST_BINS - 1;
+}
+
+int64_t aps_hist_upper_ns(int b) {
+    if (b <= 0) return 1000;
+    if (b >= APS_HIST_BINS - 1) return INT64_MAX;
+    return (int64_t)(1ULL << b) * 1000;
+}
+
+/* Écrivain unique: le thread de la classe de la tâche */
+static void stats_record(aps_task_t *t, int64_t late, int64_t exec, int overrun, uint64_t skip,
+                         int restored) {
+    aps_task_stats_t *s = &t->stats;
+    uint32_t seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    if (s->runs == 0 || late < s->late_min_ns) s->late_min_ns = late;
+    if (s->runs == 0 || late > s->late_max_ns) s->late_max_ns = late;
+    if (s->runs == 0 || exec < s->exec_min_ns) s->exec_min_ns = exec;
+    if (s->runs == 0 || exec > s->exec_max_ns) s->exec_max_ns = exec;
+    s->late_sum_ns += late;
+    s->exec_sum_ns += exec;
+    s->late_hist[hist_bin(late)]++;
+    s->exec_hist[hist_bin(exec)]++;
+    s->runs++;
+    s->missed += skip;
+    s->overruns += (uint64_t)overrun;
+    s->restores += (uint64_t)restored;
+
+    atomic_store_explicit(&t->seq, seq + 2, memory_order_release);
+}
+
+/* Activation délestée: ni retard ni durée enregistrés */
+static void stats_shed(aps_task_t *t, uint64_t skip) {
+    uint32_t seq = atomic_load_explicit(&t->seq, memory_order_relaxed);
+    atomic_store_explicit(&t->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    t->stats.shed++;
+    t->stats.missed += skip;
+    atomic_store_explicit(&t->seq, seq + 2, memory_order_release);
+}
+
+int aps_task_stats(const aps_scheduler_t *sch, int idx, aps_task_stats_t *out) {
+    if (idx < 0 || idx >= sch->count) return -1;
+    aps_task_t *t = &sch->tasks[idx];
+    for (;;) {
+        uint32_t s1 = atomic_load_explicit(&t->seq, memory_order_acquire);
+        if (s1 & 1u) continue; // écriture en cours (quelques dizaines de ns)
+        memcpy(out, &t->stats, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&t->seq, memory_order_relaxed) == s1) return 0;
+    }
+}
+
+/* Plus petite borne haute couvrant la fraction q des mesures */
+static double hist_quantile_us(const uint32_t *h, uint64_t total, int64_t max_ns, double q) {
+    uint64_t rank = (uint64_t)(q * (double)total + 0.5), acc = 0;
+    if (rank == 0) rank = 1;
+    for (int b = 0; b < APS_HIST_BINS; ++b) {
+        acc += h[b];
+        if (acc >= rank) {
+            int64_t up = aps_hist_upper_ns(b);
+            return (double)(up < max_ns ? up : max_ns) / 1e3;
+        }
+    }
+    return (double)max_ns / 1e3;
+}
+
+int aps_build_json(const aps_scheduler_t *sch, const char *const *names, int n_names,
+                   char *buf, size_t sz) {
+    aps_ovl_stats_t ovl;
+    aps_overload_stats(sch, &ovl);
+    int n = snprintf(buf, sz, "{\n  \"unit\": \"us\",\n"
+                     "  \"overload\": {\"active\":%s,\"enters\":%llu,\"exits\":%llu},\n  \"tasks\": [\n",
+                     ovl.active ? "true" : "false", (unsigned long long)ovl.enters,
+                     (unsigned long long)ovl.exits);
+    for (int i = 0; i < sch->count && n > 0 && (size_t)n < sz; ++i) {
+        const aps_task_t *t = &sch->tasks[i];
+        aps_task_stats_t s;
+        aps_task_stats(sch, i, &s);
+        char def[16];
+        snprintf(def, sizeof(def), "task%d", i);
+        double runs = s.runs ? (double)s.runs : 1.0;
+        n += snprintf(buf + n, sz - (size_t)n,
+                      "    {\"name\":\"%s\",\"class\":\"%s\",\"crit\":\"%s\",\"period_ms\":%u,\"runs\":%llu,"
+                      "\"missed\":%llu,\"overruns\":%llu,\"shed\":%llu,\"restores\":%llu,"
+                      "\"late\":{\"min\":%.1f,\"mean\":%.1f,\"p99\":%.1f,\"max\":%.1f},"
+                      "\"exec\":{\"min\":%.1f,\"mean\":%.1f,\"p99\":%.1f,\"max\":%.1f}}%s\n",
+                      (names && i < n_names && names[i]) ? names[i] : def, class_names[t->cls],
+                      crit_names[t->crit],
+                      (unsigned)atomic_load_explicit(&t->period_ms, memory_order_relaxed),
+                      (unsigned long long)s.runs, (unsigned long long)s.missed,
+                      (unsigned long long)s.overruns, (unsigned long long)s.shed,
+                      (unsigned long long)s.restores,
+                      (double)s.late_min_ns / 1e3, (double)s.late_sum_ns / runs / 1e3,
+                      s.runs ? hist_quantile_us(s.late_hist, s.runs, s.late_max_ns, 0.99) : 0.0,
+                      (double)s.late_max_ns / 1e3,
+                      (double)s.exec_min_ns / 1e3, (double)s.exec_sum_ns / runs / 1e3,
+                      s.runs ? hist_quantile_us(s.exec_hist, s.runs, s.exec_max_ns, 0.99) : 0.0,
+                      (double)s.exec_max_ns / 1e3, (i == sch->count - 1) ? "" : ",");
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "  ]\n}\n");
+    return n;
+}
+
+/* -------------------- Analyse de temps de réponse -------------------- */
+
+/* j plus prioritaire que i: RT avant NRT, puis rate-monotonic, puis ordre d'ajout */
+static int rta_higher(const aps_task_t *tasks, const int64_t *T, int j, int i) {
+    if (tasks[j].cls != tasks[i].cls) return tasks[j].cls < tasks[i].cls;
+    if (T[j] != T[i]) return T[j] < T[i];
+    return j < i;
+}
+
+/* Analyse des n premières tâches; la tâche ov_idx (si >= 0) prend la période ov_period_ms */
+static void rta_compute(const aps_scheduler_t *sch, int n, int ov_idx, uint32_t ov_period_ms,
+                        aps_rta_t *out) {
+    const aps_task_t *tasks = sch->tasks;
+    int64_t C[APS_MAX_TASKS], T[APS_MAX_TASKS];
+    int n_cls[APS_CLASS_COUNT] = {0};
+    memset(out, 0, sizeof(*out));
+    out->n = n;
+    out->schedulable = 1;
+
+    for (int i = 0; i < n; ++i) {
+        uint32_t p = (i == ov_idx) ? ov_period_ms
+                   : atomic_load_explicit(&tasks[i].period_ms, memory_order_relaxed);
+        T[i] = (int64_t)p * 1000000LL;
+        out->task[i].period_ms = p;
+        int64_t meas = 0;
+        aps_task_stats_t s;
+        if (aps_task_stats(sch, i, &s) == 0) meas = s.exec_max_ns; // tâche candidate: aucune mesure
+        int64_t budget = (int64_t)tasks[i].budget_us * 1000LL;
+        C[i] = meas > budget ? meas : budget;
+        out->task[i].meas_us = (double)meas / 1e3;
+        out->task[i].c_us = (double)C[i] / 1e3;
+        out->task[i].util = (double)C[i] / (double)T[i];
+        out->util[tasks[i].cls] += out->task[i].util;
+        out->util_total += out->task[i].util;
+        n_cls[tasks[i].cls]++;
+    }
+    for (int c = 0; c < APS_CLASS_COUNT; ++c) {
+        out->ll_bound[c] = n_cls[c] ? n_cls[c] * (pow(2.0, 1.0 / n_cls[c]) - 1.0) : 1.0;
+    }
+
+    for (int i = 0; i < n; ++i) {
+        // Blocage: un travail de chaque tâche moins prioritaire de la classe (non préemptif)
+        int64_t B = 0;
+        for (int j = 0; j < n; ++j) {
+            if (j != i && tasks[j].cls == tasks[i].cls && !rta_higher(tasks, T, j, i)) B += C[j];
+        }
+        int64_t r = C[i] + B, prev;
+        do {
+            prev = r;
+            r = C[i] + B;
+            for (int j = 0; j < n; ++j) {
+                if (j == i || !rta_higher(tasks, T, j, i)) continue;
+                r += ((prev + T[j] - 1) / T[j]) * C[j];
+            }
+        } while (r != prev && r <= T[i]);
+        out->task[i].resp_us = (double)r / 1e3;
+        out->task[i].ok = (r <= T[i]);
+        if (!out->task[i].ok) out->schedulable = 0;
+    }
+}
+
+static void rta_report(const aps_scheduler_t *sch, const aps_rta_t *rta, const char *what) {
+    for (int i = 0; i < rta->n; ++i) {
+        if (rta->task[i].ok) continue;
+        fprintf(stderr, "[WARN] APS %s: tâche %d (%s) non ordonnançable, R=%.1f ms > T=%u ms (C=%.1f ms, U=%.2f)%s\n",
+                what, i, class_names[sch->tasks[i].cls], rta->task[i].resp_us / 1e3,
+                rta->task[i].period_ms, rta->task[i].c_us / 1e3, rta->util_total,
+                sch->admit == APS_ADMIT_REJECT ? ", refusé" : "");
+    }
+}
+
+void aps_analyze(const aps_scheduler_t *sch, aps_rta_t *out) {
+    rta_compute(sch, sch->count, -1, 0, out);
+}
+
+int aps_budget_json(const aps_scheduler_t *sch, const char *const *names, int n_names,
+                    char *buf, size_t sz) {
+    static aps_rta_t rta; // appelé depuis un seul thread (serveur HTTP)
+    aps_analyze(sch, &rta);
+    int n = snprintf(buf, sz, "{\n  \"unit\": \"us\",\n  \"schedulable\": %s,\n"
+                     "  \"admission\": \"%s\",\n  \"util_total\": %.4f,\n  \"classes\": [",
+                     rta.schedulable ? "true" : "false",
+                     sch->admit == APS_ADMIT_REJECT ? "reject" : "warn", rta.util_total);
+    for (int c = 0; c < APS_CLASS_COUNT && n > 0 && (size_t)n < sz; ++c) {
+        n += snprintf(buf + n, sz - (size_t)n, "%s{\"class\":\"%s\",\"util\":%.4f,\"ll_bound\":%.4f}",
+                      c ? "," : "", class_names[c], rta.util[c], rta.ll_bound[c]);
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "],\n  \"tasks\": [\n");
+    for (int i = 0; i < rta.n && n > 0 && (size_t)n < sz; ++i) {
+        const aps_task_t *t = &sch->tasks[i];
+        char def[16];
+        snprintf(def, sizeof(def), "task%d", i);
+        n += snprintf(buf + n, sz - (size_t)n,
+                      "    {\"name\":\"%s\",\"class\":\"%s\",\"period_ms\":%u,\"budget\":%u,"
+                      "\"measured\":%.1f,\"c\":%.1f,\"util\":%.4f,\"resp\":%.1f,\"ok\":%s}%s\n",
+                      (names && i < n_names && names[i]) ? names[i] : def, class_names[t->cls],
+                      rta.task[i].period_ms, t->budget_us,
+                      rta.task[i].meas_us, rta.task[i].c_us, rta.task[i].util, rta.task[i].resp_us,
+                      rta.task[i].ok ? "true" : "false", (i == rta.n - 1) ? "" : ",");
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "  ]\n}\n");
+    return n;
+}
+
+/* -------------------- Thread d'une classe -------------------- */
 
+/* Politique et épinglage du thread courant; repli SCHED_OTHER / sans épinglage */
+void aps_apply_policy(const char *who, int policy, int priority, int cpu) {
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            fprintf(stderr, "[WARN] %s: épinglage CPU %d impossible (%s), non épinglé.\n",
+                    who, cpu, strerror(rc));
+            cpu = -1;
+        }
+    }
+    if (policy != SCHED_OTHER) {
+        struct sched_param sp = { .sched_priority = priority };
+        int rc = pthread_setschedparam(pthread_self(), policy, &sp);
+        if (rc != 0) {
+            fprintf(stderr, "[WARN] %s: politique %s/%d refusée (%s), SCHED_OTHER cpu=%d.\n",
+                    who, policy == SCHED_FIFO ? "FIFO" : "RR", priority, strerror(rc), cpu);
+            return;
+        }
+    }
+    fprintf(stdout, "[INFO] %s: %s prio=%d cpu=%d\n", who,
+            policy == SCHED_FIFO ? "SCHED_FIFO" : policy == SCHED_RR ? "SCHED_RR" : "SCHED_OTHER",
+            policy == SCHED_OTHER ? 0 : priority, cpu);
+}
+
+static void apply_class(const aps_runq_t *rq) {
+    char who[32];
+    snprintf(who, sizeof(who), "APS %s (%d tâche(s))", class_names[rq->cls], rq->n);
+    aps_apply_policy(who, rq->cfg.policy, rq->cfg.priority, rq->cfg.cpu);
+}
+
+/* -------------------- Surcharge et délestage -------------------- */
 
-static void ts_now(struct timespec *ts) {
-    clock_gettime(CLOCK_MONOTONIC, ts);
+/* Tâche HI: dépassements consécutifs -> surcharge, marge retrouvée -> fin */
+static void ovl_update(aps_scheduler_t *sch, aps_task_t *t, int bad, int slack_ok) {
+    if (bad) {
+        t->ovl_good = 0;
+        if (!t->ovl_on && ++t->ovl_bad >= APS_OVL_ENTER) {
+            t->ovl_on = 1;
+            atomic_fetch_add_explicit(&sch->overload, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&sch->ovl_enters, 1, memory_order_relaxed);
+        }
+        return;
+    }
+    t->ovl_bad = 0;
+    if (!slack_ok) {
+        t->ovl_good = 0;
+    } else if (t->ovl_on && ++t->ovl_good >= APS_OVL_EXIT) {
+        t->ovl_on = 0;
+        t->ovl_good = 0;
+        atomic_fetch_sub_explicit(&sch->overload, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&sch->ovl_exits, 1, memory_order_relaxed);
+    }
 }
 
+/* Tâche échue: 1 si l'activation est délestée; transitions journalisées */
+static int shed_decide(aps_scheduler_t *sch, aps_task_t *t, int *restored) {
+    int idx = (int)(t - sch->tasks);
+    if (t->crit != APS_CRIT_HI && atomic_load_explicit(&sch->overload, memory_order_relaxed) > 0) {
+        if (!t->shedding) {
+            t->shedding = 1;
+            t->stretch = 0;
+            t->shed_run = 0;
+            fprintf(stdout, "[WARN] APS: surcharge, tâche %d (%s) %s.\n", idx, crit_names[t->crit],
+                    t->crit == APS_CRIT_LO ? "suspendue" : "étirée");
+        }
+        if (t->crit == APS_CRIT_MID && ++t->stretch >= APS_OVL_STRETCH) {
+            t->stretch = 0;
+            return 0;
+        }
+        t->shed_run++;
+        return 1;
+    }
+    if (t->shedding) {
+        t->shedding = 0;
+        *restored = 1;
+        fprintf(stdout, "[INFO] APS: tâche %d (%s) rétablie après %llu activation(s) délestée(s).\n",
+                idx, crit_names[t->crit], (unsigned long long)t->shed_run);
+    }
+    return 0;
+}
+
+/* timerfd de la classe: exécute les activations échues puis réarme sur la suivante */
+static void aps_on_timer(int fd, uint32_t events, void *ctx) {
+    (void)events;
+    aps_runq_t *rq = (aps_runq_t*)ctx;
+    aps_scheduler_t *sch = rq->sch;
+    evl_timer_ack(fd);
+
+    while (rq->n > 0) {
+        aps_task_t *t = &sch->tasks[rq->heap[0]];
+        int64_t t_start = now_ns();
+        if (t->release_ns > t_start) break; // pas encore échue: réarmement
+        int restored = 0;
+        int shed = shed_decide(sch, t, &restored);
+        int64_t now = t_start;
+        if (!shed) {
+            t->fn(t->ctx);
+            now = now_ns();
+        }
+        int64_t late = t_start - t->release_ns;
+
+        // Activation suivante sur la grille base + k*période; en retard de
+        // plus d'une période, seule la dernière échéance passée est exécutée
+        // (immédiatement), les précédentes sont sautées. Changement de
+        // période: nouvelle grille à partir de l'activation exécutée.
+        uint32_t req = atomic_exchange_explicit(&t->period_req, 0, memory_order_relaxed);
+        if (req) {
+            t->base_ns = t->release_ns;
+            t->k = 0;
+            atomic_store_explicit(&t->period_ms, req, memory_order_relaxed);
+        }
+        t->k++;
+        t->release_ns = release_of(t, t->k);
+        int64_t period_ns = (int64_t)atomic_load_explicit(&t->period_ms, memory_order_relaxed) * 1000000LL;
+        int overrun = now > t->release_ns;
+        uint64_t skip = 0;
+        if (now - t->release_ns >= period_ns) {
+            skip = (uint64_t)((now - t->release_ns) / period_ns);
+            t->k += skip;
+            t->release_ns = release_of(t, t->k);
+        }
+        if (shed) {
+            stats_shed(t, skip);
+        } else {
+            stats_record(t, late, now - t_start, overrun, skip, restored);
+        }
+        if (t->crit == APS_CRIT_HI) {
+            ovl_update(sch, t, overrun || skip,
+                       (t->release_ns - now) * 100 >= period_ns * APS_OVL_SLACK_PCT);
+        }
+        heap_down(rq, 0);
+    }
+    if (rq->n > 0) evl_timer_arm_abs(rq->tfd, sch->tasks[rq->heap[0]].release_ns);
+}
+
+static void* aps_class_thread(void *arg) {
+    aps_runq_t *rq = (aps_runq_t*)arg;
+    apply_class(rq);
+    if (rq->n > 0) evl_timer_arm_abs(rq->tfd, rq->sch->tasks[rq->heap[0]].release_ns);
+    evl_run(&rq->loop);
+    return NULL;
+}
+
+/* -------------------- API publique -------------------- */
+
 void aps_init(aps_scheduler_t *sch, aps_task_t *tasks_buf, int max_tasks) {
+    memset(sch, 0, sizeof(*sch));
     sch->tasks = tasks_buf;
-    sch->max_tasks = max_tasks;
+    sch->max_tasks = max_tasks > APS_MAX_TASKS ? APS_MAX_TASKS : max_tasks;
     sch->count = 0;
-    ts_now(&sch->start_ts);
+    for (int c = 0; c < APS_CLASS_COUNT; ++c) {
+        sch->rq[c].sch = sch;
+        sch->rq[c].cls = (aps_class_t)c;
+        sch->rq[c].cfg = (aps_class_cfg_t){ SCHED_OTHER, 0, -1 };
+        aps_runq_t *rq = &sch->rq[c];
+        rq->tfd = -1;
+        if (evl_init(&rq->loop) != 0) continue;
+        rq->tfd = evl_timer_create();
+        if (rq->tfd >= 0 && evl_add(&rq->loop, rq->tfd, EPOLLIN, aps_on_timer, rq) != 0) {
+            fprintf(stderr, "[ERROR] APS %s: timerfd non enregistré.\n", class_names[c]);
+            close(rq->tfd);
+            rq->tfd = -1;
+        }
+    }
+    sch->rq[APS_CLASS_RT].cfg = (aps_class_cfg_t){ SCHED_FIFO, 80, -1 };
+    clock_gettime(CLOCK_MONOTONIC, &sch->start_ts);
+}
+
+int aps_set_class(aps_scheduler_t *sch, aps_class_t cls, int policy, int priority, int cpu) {
+    if ((unsigned)cls >= APS_CLASS_COUNT) return -1;
+    if (policy != SCHED_FIFO && policy != SCHED_RR && policy != SCHED_OTHER) return -1;
+    if (policy != SCHED_OTHER) {
+        int lo = sched_get_priority_min(policy), hi = sched_get_priority_max(policy);
+        if (priority < lo) priority = lo;
+        if (priority > hi) priority = hi;
+    }
+    sch->rq[cls].cfg = (aps_class_cfg_t){ policy, priority, cpu < 0 ? -1 : cpu };
+    return 0;
+}
+
+int aps_set_criticality(aps_scheduler_t *sch, int idx, aps_crit_t crit) {
+    if (idx < 0 || idx >= sch->count || crit < APS_CRIT_HI || crit > APS_CRIT_LO) return -1;
+    sch->tasks[idx].crit = crit;
+    return 0;
+}
+
+void aps_overload_stats(const aps_scheduler_t *sch, aps_ovl_stats_t *out) {
+    out->active = atomic_load_explicit(&sch->overload, memory_order_relaxed);
+    out->enters = atomic_load_explicit(&sch->ovl_enters, memory_order_relaxed);
+    out->exits  = atomic_load_explicit(&sch->ovl_exits, memory_order_relaxed);
+}
+
+void aps_set_admission(aps_scheduler_t *sch, aps_admit_t mode) {
+    sch->admit = mode;
 }
 
 int aps_add_task(aps_scheduler_t *sch, aps_task_fn_t fn, void *ctx,
-                 uint32_t period_ms, uint32_t offset_ms) {
-    if (sch->count >= sch->max_tasks) return -1;
-    aps_task_t *t = &sch->tasks[sch->count++];
+                 uint32_t period_ms, uint32_t offset_ms, uint32_t budget_us, aps_class_t cls) {
+    if (sch->count >= sch->max_tasks || (unsigned)cls >= APS_CLASS_COUNT) return -1;
+    int idx = sch->count;
+    aps_task_t *t = &sch->tasks[idx];
+    memset(t, 0, sizeof(*t));
     t->fn = fn;
     t->ctx = ctx;
-    t->period_ms = period_ms;
+    t->period_ms = period_ms ? period_ms : 1;
     t->offset_ms = offset_ms;
-    t->offset_applied = 0;
-    // Initialise "last_ts" à start - period pour permettre une exécution dès que due.
-    struct timespec start = sch->start_ts;
-    // recule last_ts pour que (now - last_ts) ~ period au 1er passage
-    t->last_ts = start;
+    t->budget_us = budget_us;
+    t->cls = cls;
+    // 1re activation à start + offset, puis toutes les périodes
+    t->base_ns = ts_to_ns(&sch->start_ts) + (int64_t)offset_ms * 1000000LL;
+    t->k = 0;
+    t->release_ns = release_of(t, 0);
+
+    // Admission: ensemble existant + candidate (pas encore comptée)
+    aps_rta_t rta;
+    rta_compute(sch, idx + 1, -1, 0, &rta);
+    if (!rta.schedulable) {
+        rta_report(sch, &rta, "admission");
+        if (sch->admit == APS_ADMIT_REJECT) return -2;
+    }
+    sch->count++;
+    aps_runq_t *rq = &sch->rq[cls];
+    rq->heap[rq->n++] = (uint8_t)idx;
+    heap_up(rq, rq->n - 1);
+    return idx;
+}
+
+int aps_set_period(aps_scheduler_t *sch, int idx, uint32_t period_ms) {
+    if (idx < 0 || idx >= sch->count) return -1;
+    if (period_ms == 0) period_ms = 1;
+    aps_rta_t rta;
+    rta_compute(sch, sch->count, idx, period_ms, &rta);
+    if (!rta.schedulable) {
+        rta_report(sch, &rta, "période");
+        if (sch->admit == APS_ADMIT_REJECT) return -2;
+    }
+    atomic_store_explicit(&sch->tasks[idx].period_req, period_ms, memory_order_relaxed);
     return 0;
 }
 
-void aps_run(aps_scheduler_t *sch) {
-    // Boucle simple avec sleep court pour limiter l’usage CPU (1 ms).
-    while (1) {
-        struct timespec now;
-        ts_now(&now);
-
-        for (int i = 0; i < sch->count; ++i) {
-            aps_task_t *t = &sch->tasks[i];
-
-            // Gestion de l’offset initial (exécuté une seule fois)
-            if (!t->offset_applied) {
-                int64_t since_start_ms = ts_diff_ms(&now, &sch->start_ts);
-                if ((int64_t)t->offset_ms <= since_start_ms) {
-                        t->fn(t->ctx);
-                        t->last_ts = now;
-                        t->offset_applied = 1;
-                }
-                continue; // tant que l’offset n’est pas consommé, ne pas exécuter périodiquement
-            }
+int aps_add_source(aps_scheduler_t *sch, aps_class_t cls, int fd, uint32_t events,
+                   evl_fn_t fn, void *ctx) {
+    if ((unsigned)cls >= APS_CLASS_COUNT) return -1;
+    aps_runq_t *rq = &sch->rq[cls];
+    if (evl_add(&rq->loop, fd, events, fn, ctx) != 0) return -1;
+    rq->n_src++;
+    return 0;
+}
 
-            // Exécution périodique
-            int64_t since_last_ms = ts_diff_ms(&now, &t->last_ts);
-            if ((int64_t)t->period_ms <=since_last_ms ) {
-                t->fn(t->ctx);
-                ts_now(&t->last_ts);
-            }
+void aps_run(aps_scheduler_t *sch) {
+    for (int c = 0; c < APS_CLASS_COUNT; ++c) {
+        aps_runq_t *rq = &sch->rq[c];
+        if (rq->n == 0 && rq->n_src == 0) continue;
+        if (rq->n > 0 && rq->tfd < 0) {
+            fprintf(stderr, "[ERROR] APS %s: pas de timerfd, classe non démarrée.\n", class_names[c]);
+            continue;
         }
-
-        // Dors 1 ms pour ne pas tourner à vide
-        usleep(1000);
+        int rc = pthread_create(&rq->thread, NULL, aps_class_thread, rq);
+        if (rc != 0) {
+            fprintf(stderr, "[ERROR] pthread_create(APS %s): %s\n", class_names[c], strerror(rc));
+            continue;
+        }
+        rq->started = 1;
     }
+    for (int c = 0; c < APS_CLASS_COUNT; ++c) {
+        aps_runq_t *rq = &sch->rq[c];
+        if (rq->started) pthread_join(rq->thread, NULL);
+        rq->started = 0;
+        if (rq->tfd >= 0) close(rq->tfd);
+        rq->tfd = -1;
+        evl_close(&rq->loop);
+    }
+}
+
+void aps_stop(aps_scheduler_t *sch) {
+    for (int c = 0; c < APS_CLASS_COUNT; ++c) evl_stop(&sch->rq[c].loop);
+}
+
+int aps_policy_from_name(const char *name) {
+    if (!name) return -1;
+    if (strcasecmp(name, "fifo") == 0)  return SCHED_FIFO;
+    if (strcasecmp(name, "rr") == 0)    return SCHED_RR;
+    if (strcasecmp(name, "other") == 0) return SCHED_OTHER;
+    return -1;
 }
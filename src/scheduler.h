@@ -1,8 +1,11 @@
-
 // src/scheduler.h
 #pragma once
 #include <time.h>
 #include <stdint.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "evl.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,36 +14,246 @@ extern "C" {
 /**
  * APS-like: ordonnancement de tâches périodiques avec offset.
  * - Chaque "task" a une période (ms) et un offset initial (ms).
- * - Le scheduler exécute les callbacks dans un thread appelant (boucle bloquante).
+ * - Chaque tâche appartient à une classe (RT, NRT); chaque classe a son
+ *   thread, sa politique (SCHED_FIFO/RR/OTHER), sa priorité et son
+ *   épinglage CPU: une tâche NRT (fichiers, printf) ne retarde jamais le
+ *   thread RT. aps_run() lance les threads et bloque jusqu'à leur fin.
+ *   Sans CAP_SYS_NICE (ou CPU absent), la classe tourne en SCHED_OTHER /
+ *   sans épinglage, avec un avertissement.
+ * - Activations à instants absolus start + offset + k*période (pas de dérive
+ *   de la durée des callbacks), rangées dans un tas min par classe. Chaque
+ *   thread de classe est un réacteur epoll (cf. evl.h): un timerfd armé en
+ *   absolu sur la plus proche échéance, plus les sources d'E/S enregistrées
+ *   par aps_add_source (entrées gpiod...); il ne se réveille que sur une
+ *   échéance ou un événement, et traite les E/S entre deux cycles. À
+ *   échéance égale, ordre d'ajout. En retard (callback plus long que la
+ *   période), la dernière échéance passée est exécutée aussitôt, les
+ *   précédentes sont sautées et comptées (pas de rafale de rattrapage); la
+ *   phase est conservée.
+ * - Statistiques par tâche (retard de démarrage sur l'échéance, durée
+ *   d'exécution: min/max/moyenne, histogramme log2, dépassements), écrites
+ *   par le thread de la classe sous seqlock: lecture sans verrou depuis
+ *   n'importe quel thread (aps_task_stats, GET /tasks).
+ * - Contrôle d'admission: analyse du temps de réponse (RTA) en priorités
+ *   rate-monotonic (période plus courte = plus prioritaire), échéance =
+ *   période. Coût retenu C = max(budget déclaré, durée max mesurée). Dans
+ *   une classe, exécution non préemptive dans l'ordre des échéances: une
+ *   tâche peut attendre un travail de chaque tâche moins prioritaire de sa
+ *   classe (blocage B = somme de leurs C). Le thread RT préempte le NRT:
+ *   toutes les tâches RT interfèrent avec chaque tâche NRT.
+ *   R = C + B + somme(ceil(R/Tj) * Cj) sur les tâches plus prioritaires,
+ *   ordonnançable si R <= T. Appliquée à l'ajout d'une tâche et au
+ *   changement de période (aps_set_period): avertissement ou refus selon
+ *   aps_set_admission().
+ * - Délestage en surcharge: chaque tâche a une criticité. Une tâche HI en
+ *   dépassement (fin après l'échéance suivante, ou activations sautées)
+ *   APS_OVL_ENTER fois de suite met le scheduler en surcharge; elle en sort
+ *   après APS_OVL_EXIT activations consécutives terminées avec au moins
+ *   APS_OVL_SLACK_PCT % de la période de marge. En surcharge, les tâches LO
+ *   sont sautées et les tâches MID étirées (une activation sur
+ *   APS_OVL_STRETCH); rétablies dès la sortie. Activations délestées,
+ *   rétablissements et entrées/sorties de surcharge sont comptés, les
+ *   transitions journalisées.
  */
 
+#define APS_MAX_TASKS 32
+#define APS_HIST_BINS 24   // classe 0: < 1 µs, classe b: [2^(b-1), 2^b) µs, dernière: au-delà
+
+#define APS_OVL_ENTER     3   // dépassements HI consécutifs -> surcharge
+#define APS_OVL_EXIT      10  // activations HI consécutives avec marge -> fin de surcharge
+#define APS_OVL_SLACK_PCT 10  // marge minimale (% de la période) comptée pour la sortie
+#define APS_OVL_STRETCH   4   // tâche MID en surcharge: une activation sur N
+
 typedef void (*aps_task_fn_t)(void *ctx);
 
+typedef enum {
+    APS_CLASS_RT = 0,   // protection: thread temps réel
+    APS_CLASS_NRT,      // rechargement config, supervision
+    APS_CLASS_COUNT
+} aps_class_t;
+
+typedef enum {
+    APS_CRIT_HI = 0,    // jamais délestée, surveillée par le détecteur de surcharge
+    APS_CRIT_MID,       // étirée en surcharge
+    APS_CRIT_LO         // sautée en surcharge
+} aps_crit_t;
+
+typedef struct {
+    int policy;         // SCHED_FIFO, SCHED_RR ou SCHED_OTHER
+    int priority;       // 1..99 en FIFO/RR, ignorée en OTHER
+    int cpu;            // CPU d'épinglage, -1 = aucun
+} aps_class_cfg_t;
+
+typedef struct {
+    uint64_t runs;                      // Activations exécutées
+    uint64_t missed;                    // Activations sautées (retard > période)
+    uint64_t overruns;                  // Fin d'exécution après l'échéance suivante
+    uint64_t shed;                      // Activations délestées (surcharge)
+    uint64_t restores;                  // Rétablissements après délestage
+    int64_t  late_min_ns, late_max_ns;  // Retard de démarrage sur l'échéance
+    int64_t  late_sum_ns;
+    int64_t  exec_min_ns, exec_max_ns;  // Durée d'exécution du callback
+    int64_t  exec_sum_ns;
+    uint32_t late_hist[APS_HIST_BINS];
+    uint32_t exec_hist[APS_HIST_BINS];
+} aps_task_stats_t;
+
+typedef enum {
+    APS_ADMIT_WARN = 0,     // ensemble non ordonnançable accepté, avertissement
+    APS_ADMIT_REJECT        // ajout / changement de période refusé
+} aps_admit_t;
+
 typedef struct {
     aps_task_fn_t fn;       // Callback à exécuter
     void *ctx;              // Contexte passé au callback
-    uint32_t period_ms;     // Période en millisecondes
+    _Atomic uint32_t period_ms; // Période en millisecondes (écrite par le thread de la classe)
+    _Atomic uint32_t period_req; // Nouvelle période demandée (aps_set_period), 0 = aucune
     uint32_t offset_ms;     // Décalage initial en millisecondes
-    struct timespec last_ts;// Dernière exécution
-    int offset_applied;     // 0 = pas encore appliqué, 1 = offset déjà consommé
+    uint32_t budget_us;     // Durée d'exécution pire cas déclarée (0 = inconnue)
+    aps_class_t cls;        // Classe (thread d'exécution)
+    aps_crit_t crit;        // Criticité (délestage en surcharge)
+    uint32_t ovl_bad;       // HI: dépassements consécutifs
+    uint32_t ovl_good;      // HI: activations consécutives avec marge
+    uint32_t stretch;       // MID délestée: activations depuis la dernière exécutée
+    uint64_t shed_run;      // Activations délestées depuis le début du délestage
+    uint8_t  ovl_on;        // HI: cette tâche maintient la surcharge
+    uint8_t  shedding;      // MID/LO: délestage en cours
+    int64_t  base_ns;       // Origine de la grille d'activations courante
+    uint64_t k;             // Numéro de la prochaine activation
+    int64_t  release_ns;    // Prochaine activation (CLOCK_MONOTONIC, ns)
+    _Atomic uint32_t seq;   // seqlock des statistiques (impair = écriture en cours)
+    aps_task_stats_t stats;
 } aps_task_t;
 
+/* Résultat de l'analyse de temps de réponse (µs) */
 typedef struct {
+    uint32_t period_ms;     // Période analysée (T)
+    double meas_us;         // Durée d'exécution max mesurée
+    double c_us;            // Coût retenu: max(budget déclaré, max mesuré)
+    double resp_us;         // Temps de réponse pire cas R (1re itération > T si non ordonnançable)
+    double util;            // C / T
+    int    ok;              // R <= T
+} aps_rta_task_t;
+
+typedef struct {
+    int    n;
+    int    schedulable;             // toutes les tâches ok
+    double util[APS_CLASS_COUNT];   // utilisation par classe
+    double util_total;
+    double ll_bound[APS_CLASS_COUNT]; // borne de Liu & Layland n(2^(1/n) - 1)
+    aps_rta_task_t task[APS_MAX_TASKS];
+} aps_rta_t;
+
+/* Détecteur de surcharge */
+typedef struct {
+    int      active;        // tâches HI en surcharge (0 = nominal)
+    uint64_t enters;        // entrées en surcharge
+    uint64_t exits;         // sorties de surcharge
+} aps_ovl_stats_t;
+
+typedef struct aps_scheduler aps_scheduler_t;
+
+/* File d'une classe: tas min d'index de tâches sur (release_ns, index) */
+typedef struct {
+    aps_scheduler_t *sch;
+    aps_class_t cls;
+    aps_class_cfg_t cfg;
+    int n;
+    uint8_t heap[APS_MAX_TASKS];
+    evl_t loop;             // réacteur de la classe
+    int tfd;                // timerfd de la plus proche échéance
+    int n_src;              // sources d'E/S enregistrées
+    pthread_t thread;
+    int started;
+} aps_runq_t;
+
+struct aps_scheduler {
     aps_task_t *tasks;
     int max_tasks;
     int count;
     struct timespec start_ts;
-} aps_scheduler_t;
+    aps_admit_t admit;
+    _Atomic int overload;           // tâches HI en surcharge
+    _Atomic uint64_t ovl_enters;
+    _Atomic uint64_t ovl_exits;
+    aps_runq_t rq[APS_CLASS_COUNT];
+};
 
-/** Initialise le scheduler avec un tableau de tâches pré-alloué. */
+/**
+ * Initialise le scheduler avec un tableau de tâches pré-alloué (APS_MAX_TASKS
+ * au plus). Classes par défaut: RT = SCHED_FIFO 80, NRT = SCHED_OTHER, sans épinglage.
+ */
 void aps_init(aps_scheduler_t *sch, aps_task_t *tasks_buf, int max_tasks);
 
-/** Ajoute une tâche (retourne 0 si OK, -1 si plein). */
+/** Politique, priorité et CPU d'une classe (avant aps_run). Retourne 0 si OK. */
+int aps_set_class(aps_scheduler_t *sch, aps_class_t cls, int policy, int priority, int cpu);
+
+/** Criticité de la tâche idx (défaut APS_CRIT_HI: jamais délestée). Avant aps_run. */
+int aps_set_criticality(aps_scheduler_t *sch, int idx, aps_crit_t crit);
+/** État et compteurs du détecteur de surcharge (tout thread). */
+void aps_overload_stats(const aps_scheduler_t *sch, aps_ovl_stats_t *out);
+
+/** Politique d'admission (défaut APS_ADMIT_WARN). */
+void aps_set_admission(aps_scheduler_t *sch, aps_admit_t mode);
+
+/**
+ * Ajoute une tâche à une classe, budget_us = durée d'exécution pire cas
+ * déclarée (0 = inconnue). Retourne l'indice de la tâche (>= 0, à passer à
+ * aps_set_period/aps_set_criticality), -1 si plein, -2 si l'ensemble ne
+ * serait plus ordonnançable en APS_ADMIT_REJECT.
+ */
 int aps_add_task(aps_scheduler_t *sch, aps_task_fn_t fn, void *ctx,
-                 uint32_t period_ms, uint32_t offset_ms);
+                 uint32_t period_ms, uint32_t offset_ms, uint32_t budget_us, aps_class_t cls);
+
+/**
+ * Change la période de la tâche idx en cours d'exécution (tout thread),
+ * appliquée par le thread de la classe après la prochaine activation.
+ * Retourne 0 si OK, -1 si idx invalide, -2 si refusée (APS_ADMIT_REJECT).
+ */
+int aps_set_period(aps_scheduler_t *sch, int idx, uint32_t period_ms);
+
+/** Analyse de temps de réponse de l'ensemble courant (coûts mesurés inclus). */
+void aps_analyze(const aps_scheduler_t *sch, aps_rta_t *out);
+/** JSON du budget d'utilisation et des temps de réponse (cf. aps_build_json). */
+int aps_budget_json(const aps_scheduler_t *sch, const char *const *names, int n_names,
+                    char *buf, size_t sz);
+
+/**
+ * Enregistre une source d'E/S (fd, EPOLLIN...) dans le réacteur d'une classe:
+ * fn est appelé dans le thread de la classe, entre deux cycles. Avant aps_run.
+ * Retourne 0 si OK, -1 sinon.
+ */
+int aps_add_source(aps_scheduler_t *sch, aps_class_t cls, int fd, uint32_t events,
+                   evl_fn_t fn, void *ctx);
 
-/** Boucle d’exécution bloquante (appelle les callbacks quand ils sont dus). */
+/** Boucle d’exécution bloquante (un thread par classe ayant des tâches ou sources). */
 void aps_run(aps_scheduler_t *sch);
+/** Arrête les réacteurs (tout thread): aps_run retourne. */
+void aps_stop(aps_scheduler_t *sch);
+
+/**
+ * Copie cohérente des statistiques de la tâche idx (ordre d'ajout), sans
+ * verrou. Retourne 0 si OK, -1 si idx invalide.
+ */
+int aps_task_stats(const aps_scheduler_t *sch, int idx, aps_task_stats_t *out);
+/** Borne haute (ns) de la classe d'histogramme b (INT64_MAX pour la dernière). */
+int64_t aps_hist_upper_ns(int b);
+/**
+ * JSON des statistiques de toutes les tâches (µs), names[i] = nom de la
+ * tâche i pour i < n_names (sinon "task<i>"). Retourne la longueur écrite.
+ */
+int aps_build_json(const aps_scheduler_t *sch, const char *const *names, int n_names,
+                   char *buf, size_t sz);
+
+/** "fifo" | "rr" | "other" -> SCHED_*, -1 si inconnu. */
+int aps_policy_from_name(const char *name);
+
+/**
+ * Politique, priorité et épinglage du thread appelant (threads des classes,
+ * thread d'acquisition). Repli SCHED_OTHER / sans épinglage avec un [WARN]
+ * (ex. sans CAP_SYS_NICE); who préfixe les messages.
+ */
+void aps_apply_policy(const char *who, int policy, int priority, int cpu);
 
 /** Outil: différence (ms) entre deux timespec. */
 static inline int64_t ts_diff_ms(const struct timespec *a, const struct timespec *b) {
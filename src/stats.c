@@ -0,0 +1,344 @@
+// src/stats.c
+#include "stats.h"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define STATS_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define STATS_NEON 1
+#include <arm_neon.h>
+#endif
+
+/*
+ * Accumulateurs d'un bloc, données décalées de k = x[0]:
+ *   s1 = Σ(x-k), s2 = Σ(x-k)²  ->  var = s2/n - (s1/n)², mean = k + s1/n
+ */
+typedef struct {
+    double s1, s2;
+    double mn, mx;
+} acc_t;
+
+typedef void (*acc_f64_fn)(const double *x, size_t n, double k, acc_t *a);
+typedef void (*acc_f32_fn)(const float *x, size_t n, double k, acc_t *a);
+
+static void finish(const acc_t *a, double k, size_t n, stats_block_t *out) {
+    double m1  = a->s1 / (double)n;
+    double var = a->s2 / (double)n - m1 * m1;
+    if (var < 0.0) var = 0.0; // annulation numérique possible
+
+    out->n    = n;
+    out->mean = k + m1;
+    out->min  = a->mn;
+    out->max  = a->mx;
+    out->var  = var;
+    out->rms  = sqrt(var + out->mean * out->mean); // E[x²] = var + mean²
+    double peak = fmax(fabs(a->mn), fabs(a->mx));
+    out->crest = (out->rms > 0.0) ? peak / out->rms : 0.0;
+}
+
+/* -------------------- Scalaire -------------------- */
+
+static void acc_scalar_f64(const double *x, size_t n, double k, acc_t *a) {
+    for (size_t i = 0; i < n; ++i) {
+        double d = x[i] - k;
+        a->s1 += d;
+        a->s2 += d * d;
+        if (x[i] < a->mn) a->mn = x[i];
+        if (x[i] > a->mx) a->mx = x[i];
+    }
+}
+
+static void acc_scalar_f32(const float *x, size_t n, double k, acc_t *a) {
+    for (size_t i = 0; i < n; ++i) {
+        double v = x[i], d = v - k;
+        a->s1 += d;
+        a->s2 += d * d;
+        if (v < a->mn) a->mn = v;
+        if (v > a->mx) a->mx = v;
+    }
+}
+
+/* -------------------- x86: SSE2 / AVX -------------------- */
+
+#ifdef STATS_X86
+
+__attribute__((target("sse2")))
+static void reduce_sse2(__m128d s1, __m128d s2, __m128d mn, __m128d mx, acc_t *a) {
+    double t1[2], t2[2], tn[2], tx[2];
+    _mm_storeu_pd(t1, s1);
+    _mm_storeu_pd(t2, s2);
+    _mm_storeu_pd(tn, mn);
+    _mm_storeu_pd(tx, mx);
+    a->s1 += t1[0] + t1[1];
+    a->s2 += t2[0] + t2[1];
+    for (int j = 0; j < 2; ++j) {
+        if (tn[j] < a->mn) a->mn = tn[j];
+        if (tx[j] > a->mx) a->mx = tx[j];
+    }
+}
+
+__attribute__((target("sse2")))
+static void acc_sse2_f64(const double *x, size_t n, double k, acc_t *a) {
+    const __m128d vk = _mm_set1_pd(k);
+    __m128d s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd();
+    __m128d mn = _mm_set1_pd(a->mn), mx = _mm_set1_pd(a->mx);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128d v = _mm_loadu_pd(x + i);
+        __m128d d = _mm_sub_pd(v, vk);
+        s1 = _mm_add_pd(s1, d);
+        s2 = _mm_add_pd(s2, _mm_mul_pd(d, d));
+        mn = _mm_min_pd(mn, v);
+        mx = _mm_max_pd(mx, v);
+    }
+    reduce_sse2(s1, s2, mn, mx, a);
+    acc_scalar_f64(x + i, n - i, k, a);
+}
+
+__attribute__((target("sse2")))
+static void acc_sse2_f32(const float *x, size_t n, double k, acc_t *a) {
+    const __m128d vk = _mm_set1_pd(k);
+    __m128d s1 = _mm_setzero_pd(), s2 = _mm_setzero_pd();
+    __m128d mn = _mm_set1_pd(a->mn), mx = _mm_set1_pd(a->mx);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128  f  = _mm_loadu_ps(x + i);
+        __m128d lo = _mm_cvtps_pd(f);
+        __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(f, f));
+        __m128d dl = _mm_sub_pd(lo, vk), dh = _mm_sub_pd(hi, vk);
+        s1 = _mm_add_pd(s1, _mm_add_pd(dl, dh));
+        s2 = _mm_add_pd(s2, _mm_add_pd(_mm_mul_pd(dl, dl), _mm_mul_pd(dh, dh)));
+        mn = _mm_min_pd(mn, _mm_min_pd(lo, hi));
+        mx = _mm_max_pd(mx, _mm_max_pd(lo, hi));
+    }
+    reduce_sse2(s1, s2, mn, mx, a);
+    acc_scalar_f32(x + i, n - i, k, a);
+}
+
+__attribute__((target("avx")))
+static void reduce_avx(__m256d s1, __m256d s2, __m256d mn, __m256d mx, acc_t *a) {
+    double t1[4], t2[4], tn[4], tx[4];
+    _mm256_storeu_pd(t1, s1);
+    _mm256_storeu_pd(t2, s2);
+    _mm256_storeu_pd(tn, mn);
+    _mm256_storeu_pd(tx, mx);
+    // Registres ymm propres avant le code SSE (queue scalaire, libm): évite la
+    // pénalité de transition AVX -> SSE, sensible sur les petits blocs.
+    _mm256_zeroupper();
+    for (int j = 0; j < 4; ++j) {
+        a->s1 += t1[j];
+        a->s2 += t2[j];
+        if (tn[j] < a->mn) a->mn = tn[j];
+        if (tx[j] > a->mx) a->mx = tx[j];
+    }
+}
+
+/* Deux jeux d'accumulateurs: masque la latence des additions (chaîne de dépendance). */
+__attribute__((target("avx")))
+static void acc_avx_f64(const double *x, size_t n, double k, acc_t *a) {
+    const __m256d vk = _mm256_set1_pd(k);
+    __m256d s1a = _mm256_setzero_pd(), s2a = _mm256_setzero_pd();
+    __m256d s1b = _mm256_setzero_pd(), s2b = _mm256_setzero_pd();
+    __m256d mn = _mm256_set1_pd(a->mn), mx = _mm256_set1_pd(a->mx);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d va = _mm256_loadu_pd(x + i);
+        __m256d vb = _mm256_loadu_pd(x + i + 4);
+        __m256d da = _mm256_sub_pd(va, vk), db = _mm256_sub_pd(vb, vk);
+        s1a = _mm256_add_pd(s1a, da);
+        s1b = _mm256_add_pd(s1b, db);
+        s2a = _mm256_add_pd(s2a, _mm256_mul_pd(da, da));
+        s2b = _mm256_add_pd(s2b, _mm256_mul_pd(db, db));
+        mn = _mm256_min_pd(mn, _mm256_min_pd(va, vb));
+        mx = _mm256_max_pd(mx, _mm256_max_pd(va, vb));
+    }
+    reduce_avx(_mm256_add_pd(s1a, s1b), _mm256_add_pd(s2a, s2b), mn, mx, a);
+    acc_scalar_f64(x + i, n - i, k, a);
+}
+
+__attribute__((target("avx")))
+static void acc_avx_f32(const float *x, size_t n, double k, acc_t *a) {
+    const __m256d vk = _mm256_set1_pd(k);
+    __m256d s1a = _mm256_setzero_pd(), s2a = _mm256_setzero_pd();
+    __m256d s1b = _mm256_setzero_pd(), s2b = _mm256_setzero_pd();
+    __m256d mn = _mm256_set1_pd(a->mn), mx = _mm256_set1_pd(a->mx);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256d va = _mm256_cvtps_pd(_mm_loadu_ps(x + i));
+        __m256d vb = _mm256_cvtps_pd(_mm_loadu_ps(x + i + 4));
+        __m256d da = _mm256_sub_pd(va, vk), db = _mm256_sub_pd(vb, vk);
+        s1a = _mm256_add_pd(s1a, da);
+        s1b = _mm256_add_pd(s1b, db);
+        s2a = _mm256_add_pd(s2a, _mm256_mul_pd(da, da));
+        s2b = _mm256_add_pd(s2b, _mm256_mul_pd(db, db));
+        mn = _mm256_min_pd(mn, _mm256_min_pd(va, vb));
+        mx = _mm256_max_pd(mx, _mm256_max_pd(va, vb));
+    }
+    reduce_avx(_mm256_add_pd(s1a, s1b), _mm256_add_pd(s2a, s2b), mn, mx, a);
+    acc_scalar_f32(x + i, n - i, k, a);
+}
+
+#endif /* STATS_X86 */
+
+/* -------------------- ARM NEON -------------------- */
+
+#ifdef STATS_NEON
+
+/*
+ * ARMv7 (Cortex-A8 du BeagleBone): NEON ne traite que des float32. Les
+ * sommes partielles sont donc reversées en double tous les
+ * NEON_FLUSH échantillons pour borner l'erreur d'arrondi.
+ */
+#define NEON_FLUSH 256
+
+static inline double hsum_f32(float32x4_t v) {
+    return (double)vgetq_lane_f32(v, 0) + (double)vgetq_lane_f32(v, 1)
+         + (double)vgetq_lane_f32(v, 2) + (double)vgetq_lane_f32(v, 3);
+}
+
+static void acc_neon_f32(const float *x, size_t n, double k, acc_t *a) {
+    const float32x4_t vk = vdupq_n_f32((float)k);
+    float32x4_t mn = vdupq_n_f32((float)a->mn), mx = vdupq_n_f32((float)a->mx);
+    size_t i = 0;
+    while (i + 4 <= n) {
+        size_t end = i + NEON_FLUSH;
+        if (end > n) end = n;
+        float32x4_t s1 = vdupq_n_f32(0.0f), s2 = vdupq_n_f32(0.0f);
+        for (; i + 4 <= end; i += 4) {
+            float32x4_t v = vld1q_f32(x + i);
+            float32x4_t d = vsubq_f32(v, vk);
+            s1 = vaddq_f32(s1, d);
+            s2 = vmlaq_f32(s2, d, d);
+            mn = vminq_f32(mn, v);
+            mx = vmaxq_f32(mx, v);
+        }
+        a->s1 += hsum_f32(s1);
+        a->s2 += hsum_f32(s2);
+    }
+    for (int j = 0; j < 4; ++j) {
+        float fn = vgetq_lane_f32(mn, 0), fx = vgetq_lane_f32(mx, 0);
+        if (fn < a->mn) a->mn = fn;
+        if (fx > a->mx) a->mx = fx;
+        mn = vextq_f32(mn, mn, 1);
+        mx = vextq_f32(mx, mx, 1);
+    }
+    acc_scalar_f32(x + i, n - i, k, a);
+}
+
+#ifdef __aarch64__
+/* AArch64: NEON traite aussi les doubles (2 voies). */
+static void acc_neon_f64(const double *x, size_t n, double k, acc_t *a) {
+    const float64x2_t vk = vdupq_n_f64(k);
+    float64x2_t s1 = vdupq_n_f64(0.0), s2 = vdupq_n_f64(0.0);
+    float64x2_t mn = vdupq_n_f64(a->mn), mx = vdupq_n_f64(a->mx);
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t v = vld1q_f64(x + i);
+        float64x2_t d = vsubq_f64(v, vk);
+        s1 = vaddq_f64(s1, d);
+        s2 = vfmaq_f64(s2, d, d);
+        mn = vminq_f64(mn, v);
+        mx = vmaxq_f64(mx, v);
+    }
+    a->s1 += vaddvq_f64(s1);
+    a->s2 += vaddvq_f64(s2);
+    a->mn = fmin(a->mn, vminvq_f64(mn));
+    a->mx = fmax(a->mx, vmaxvq_f64(mx));
+    acc_scalar_f64(x + i, n - i, k, a);
+}
+#else
+/* ARMv7: pas de double en NEON, repli scalaire. */
+#define acc_neon_f64 acc_scalar_f64
+#endif
+
+#endif /* STATS_NEON */
+
+/* -------------------- Sélection du noyau -------------------- */
+
+static stats_impl_t cur_impl = STATS_IMPL_AUTO;
+static acc_f64_fn   cur_f64  = NULL;
+static acc_f32_fn   cur_f32  = NULL;
+
+int stats_impl_available(stats_impl_t impl) {
+    switch (impl) {
+    case STATS_IMPL_AUTO:
+    case STATS_IMPL_SCALAR:
+        return 1;
+#ifdef STATS_X86
+    case STATS_IMPL_SSE2:
+        return __builtin_cpu_supports("sse2");
+    case STATS_IMPL_AVX:
+        return __builtin_cpu_supports("avx");
+#endif
+#ifdef STATS_NEON
+    case STATS_IMPL_NEON:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+const char *stats_impl_name(stats_impl_t impl) {
+    switch (impl) {
+    case STATS_IMPL_AUTO:   return "auto";
+    case STATS_IMPL_SCALAR: return "scalar";
+    case STATS_IMPL_SSE2:   return "sse2";
+    case STATS_IMPL_AVX:    return "avx";
+    case STATS_IMPL_NEON:   return "neon";
+    default:                return "?";
+    }
+}
+
+int stats_set_impl(stats_impl_t impl) {
+    if (impl == STATS_IMPL_AUTO) {
+        impl = STATS_IMPL_SCALAR;
+        if (stats_impl_available(STATS_IMPL_NEON)) impl = STATS_IMPL_NEON;
+        if (stats_impl_available(STATS_IMPL_SSE2)) impl = STATS_IMPL_SSE2;
+        if (stats_impl_available(STATS_IMPL_AVX))  impl = STATS_IMPL_AVX;
+    }
+    if (!stats_impl_available(impl)) return -1;
+
+    switch (impl) {
+#ifdef STATS_X86
+    case STATS_IMPL_SSE2: cur_f64 = acc_sse2_f64; cur_f32 = acc_sse2_f32; break;
+    case STATS_IMPL_AVX:  cur_f64 = acc_avx_f64;  cur_f32 = acc_avx_f32;  break;
+#endif
+#ifdef STATS_NEON
+    case STATS_IMPL_NEON: cur_f64 = acc_neon_f64; cur_f32 = acc_neon_f32; break;
+#endif
+    default:              cur_f64 = acc_scalar_f64; cur_f32 = acc_scalar_f32; break;
+    }
+    cur_impl = impl;
+    return 0;
+}
+
+stats_impl_t stats_get_impl(void) {
+    if (!cur_f64) stats_set_impl(STATS_IMPL_AUTO);
+    return cur_impl;
+}
+
+/* -------------------- API -------------------- */
+
+int stats_block_f64(const double *x, size_t n, stats_block_t *out) {
+    if (!x || !out || n == 0) return -1;
+    if (!cur_f64) stats_set_impl(STATS_IMPL_AUTO);
+    double k = x[0];
+    acc_t a = { 0.0, 0.0, k, k };
+    cur_f64(x, n, k, &a);
+    finish(&a, k, n, out);
+    return 0;
+}
+
+int stats_block_f32(const float *x, size_t n, stats_block_t *out) {
+    if (!x || !out || n == 0) return -1;
+    if (!cur_f32) stats_set_impl(STATS_IMPL_AUTO);
+    double k = x[0];
+    acc_t a = { 0.0, 0.0, k, k };
+    cur_f32(x, n, k, &a);
+    finish(&a, k, n, out);
+    return 0;
+}
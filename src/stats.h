@@ -0,0 +1,58 @@
+// src/stats.h
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * STATS: statistiques de bloc en une seule passe sur un tableau contigu
+ * (fenêtre RMS, capture CAP...): moyenne (offset DC), min/max, variance,
+ * RMS et facteur de crête (|crête| / RMS).
+ *
+ * - Saturation capteur: min/max collés aux bornes de calibration.
+ * - Forme d'onde distordue: facteur de crête loin de sqrt(2) (sinus pur).
+ *
+ * Noyaux: SSE2 et AVX sur x86 (choix à l'exécution, __builtin_cpu_supports),
+ * NEON sur ARM (BeagleBone: compiler avec -mfpu=neon), repli scalaire partout.
+ * La variance est calculée sur les données décalées de x[0] (pas d'annulation
+ * catastrophique en présence d'un offset DC).
+ */
+
+typedef struct {
+    size_t n;
+    double mean;    // moyenne (offset DC)
+    double min;
+    double max;
+    double var;     // variance (population)
+    double rms;
+    double crest;   // max(|min|, |max|) / rms (0 si rms nul)
+} stats_block_t;
+
+typedef enum {
+    STATS_IMPL_AUTO = 0,   // meilleur noyau disponible
+    STATS_IMPL_SCALAR,
+    STATS_IMPL_SSE2,
+    STATS_IMPL_AVX,
+    STATS_IMPL_NEON,
+    STATS_IMPL_COUNT
+} stats_impl_t;
+
+/** Statistiques d'un bloc de doubles. Retourne 0 si OK, -1 si bloc vide. */
+int  stats_block_f64(const double *x, size_t n, stats_block_t *out);
+/** Idem pour des floats (accumulation en double). */
+int  stats_block_f32(const float *x, size_t n, stats_block_t *out);
+
+/** Force un noyau (bench, essais). Retourne 0 si OK, -1 si indisponible sur ce CPU. */
+int  stats_set_impl(stats_impl_t impl);
+/** Noyau effectivement utilisé. */
+stats_impl_t stats_get_impl(void);
+/** Vrai si le noyau est compilé et supporté par le CPU courant. */
+int  stats_impl_available(stats_impl_t impl);
+/** Nom lisible ("scalar", "sse2", "avx", "neon"). */
+const char *stats_impl_name(stats_impl_t impl);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,57 +1,205 @@
-
 // src/watchdog.c
 #include "watchdog.h"
 #include <time.h>
 #include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/* Canal: kick et jalons écrits par le thread surveillé, lus par le thread
+ * de vérification (NRT) et le serveur HTTP: champs atomiques. */
+typedef struct {
+    char name[16];
+    int  deadline_ms;
+    _Atomic int64_t  last_kick_ns;
+    _Atomic uint32_t head;                    // jalons écrits depuis l'init
+    struct {
+        _Atomic uint32_t      seq;            // k+1 = jalon k complet, 0 = écriture en cours
+        _Atomic(const char *) stage;
+        _Atomic int64_t       ts_ns;
+    } ring[WATCHDOG_TRACE_LEN];
+    _Atomic int      fault;
+    _Atomic uint64_t faults;
+} wd_channel_t;
+
+static wd_channel_t  g_ch[WATCHDOG_MAX_CHANNELS];
+static _Atomic int   g_nch = 0;
+
+/* Post-mortems: écrits par watchdog_check_all, lus par le serveur HTTP */
+static watchdog_pm_t   g_pm[WATCHDOG_PM_SLOTS];
+static uint64_t        g_pm_count = 0;
+static pthread_mutex_t g_pm_mtx = PTHREAD_MUTEX_INITIALIZER;
 
-static int g_timeout_ms = WATCHDOG_TIMEOUT_MS_DEFAULT;
-static struct timespec g_last_kick = {0};
-static int g_fault = 0;
+static inline int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
 
-static inline int64_t ts_diff_ms(const struct timespec *a, const struct timespec *b) {
-    int64_t s  = (int64_t)a->tv_sec  - (int64_t)b->tv_sec;
-    int64_t ns = (int64_t)a->tv_nsec - (int64_t)b->tv_nsec;
-    return s * 1000 + ns / 1000000;
+static wd_channel_t* channel(int ch) {
+    return (ch >= 0 && ch < atomic_load_explicit(&g_nch, memory_order_acquire)) ? &g_ch[ch] : NULL;
 }
 
 int watchdog_init(int timeout_ms) {
     if (timeout_ms <= 0) {
         fprintf(stderr, "[WARN] watchdog_init: timeout invalide (%d ms). Utilisation de %d ms.\n",
                 timeout_ms, WATCHDOG_TIMEOUT_MS_DEFAULT);
-        g_timeout_ms = WATCHDOG_TIMEOUT_MS_DEFAULT;
-    } else {
-        g_timeout_ms = timeout_ms;
+        timeout_ms = WATCHDOG_TIMEOUT_MS_DEFAULT;
     }
-    clock_gettime(CLOCK_MONOTONIC, &g_last_kick);
-    g_fault = 0;
-    fprintf(stdout, "[INFO] Watchdog initialisé avec timeout=%d ms.\n", g_timeout_ms);
+    atomic_store(&g_nch, 0);
+    memset(g_ch, 0, sizeof(g_ch));
+    pthread_mutex_lock(&g_pm_mtx);
+    g_pm_count = 0;
+    pthread_mutex_unlock(&g_pm_mtx);
+    watchdog_add_channel("protection", timeout_ms);
+    fprintf(stdout, "[INFO] Watchdog initialisé avec timeout=%d ms.\n", timeout_ms);
     return 0;
 }
 
+int watchdog_add_channel(const char *name, int deadline_ms) {
+    int n = atomic_load(&g_nch);
+    if (n >= WATCHDOG_MAX_CHANNELS || deadline_ms <= 0) return -1;
+    wd_channel_t *c = &g_ch[n];
+    snprintf(c->name, sizeof(c->name), "%s", name ? name : "?");
+    c->deadline_ms = deadline_ms;
+    atomic_store(&c->last_kick_ns, now_ns());
+    atomic_store(&c->head, 0);
+    atomic_store(&c->fault, 0);
+    atomic_store(&c->faults, 0);
+    atomic_store_explicit(&g_nch, n + 1, memory_order_release);
+    return n;
+}
+
+void watchdog_kick_ch(int ch) {
+    wd_channel_t *c = channel(ch);
+    if (c) atomic_store_explicit(&c->last_kick_ns, now_ns(), memory_order_relaxed);
+}
+
+void watchdog_mark(int ch, const char *stage) {
+    wd_channel_t *c = channel(ch);
+    if (!c) return;
+    uint32_t h = atomic_load_explicit(&c->head, memory_order_relaxed);
+    uint32_t i = h % WATCHDOG_TRACE_LEN;
+    /* seqlock par case: invalidée avant l'écriture, publiée après */
+    atomic_store_explicit(&c->ring[i].seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&c->ring[i].stage, stage, memory_order_relaxed);
+    atomic_store_explicit(&c->ring[i].ts_ns, now_ns(), memory_order_relaxed);
+    atomic_store_explicit(&c->ring[i].seq, h + 1, memory_order_release);
+    atomic_store_explicit(&c->head, h + 1, memory_order_release);
+}
+
+/* Copie des jalons du canal; une case en cours d'écriture ou réécrite
+ * pendant la copie (numéro de jalon changé) est écartée */
+static int trace_snapshot(wd_channel_t *c, watchdog_mark_t *out) {
+    uint32_t h = atomic_load_explicit(&c->head, memory_order_acquire);
+    uint32_t first = h > WATCHDOG_TRACE_LEN ? h - WATCHDOG_TRACE_LEN : 0;
+    int n = 0;
+    for (uint32_t k = first; k < h; ++k) {
+        uint32_t i = k % WATCHDOG_TRACE_LEN;
+        uint32_t s1 = atomic_load_explicit(&c->ring[i].seq, memory_order_acquire);
+        if (s1 != k + 1) continue;
+        watchdog_mark_t m;
+        m.stage = atomic_load_explicit(&c->ring[i].stage, memory_order_relaxed);
+        m.ts_ns = atomic_load_explicit(&c->ring[i].ts_ns, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t s2 = atomic_load_explicit(&c->ring[i].seq, memory_order_relaxed);
+        if (s2 == s1) out[n++] = m;
+    }
+    return n;
+}
+
+int watchdog_check_all(void) {
+    int nch = atomic_load_explicit(&g_nch, memory_order_acquire);
+    int expired = 0;
+    int64_t now = now_ns();
+    for (int ch = 0; ch < nch; ++ch) {
+        wd_channel_t *c = &g_ch[ch];
+        int64_t last = atomic_load_explicit(&c->last_kick_ns, memory_order_relaxed);
+        if ((now - last) / 1000000 <= c->deadline_ms) {
+            atomic_store_explicit(&c->fault, 0, memory_order_relaxed);
+            continue;
+        }
+        if (atomic_load_explicit(&c->fault, memory_order_relaxed)) continue; // déjà figé
+        atomic_store_explicit(&c->fault, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&c->faults, 1, memory_order_relaxed);
+        expired++;
+
+        pthread_mutex_lock(&g_pm_mtx);
+        watchdog_pm_t *pm = &g_pm[g_pm_count % WATCHDOG_PM_SLOTS];
+        memcpy(pm->channel, c->name, sizeof(pm->channel));
+        pm->deadline_ms  = c->deadline_ms;
+        pm->detected_ns  = now;
+        pm->last_kick_ns = last;
+        pm->n = trace_snapshot(c, pm->trace);
+        g_pm_count++;
+        pthread_mutex_unlock(&g_pm_mtx);
+    }
+    return expired;
+}
+
+int watchdog_postmortem(int i, watchdog_pm_t *out) {
+    int rc = -1;
+    pthread_mutex_lock(&g_pm_mtx);
+    if (i >= 0 && i < WATCHDOG_PM_SLOTS && (uint64_t)i < g_pm_count) {
+        *out = g_pm[(g_pm_count - 1 - (uint64_t)i) % WATCHDOG_PM_SLOTS];
+        rc = 0;
+    }
+    pthread_mutex_unlock(&g_pm_mtx);
+    return rc;
+}
+
+int watchdog_build_json(char *buf, size_t sz) {
+    int nch = atomic_load_explicit(&g_nch, memory_order_acquire);
+    int64_t now = now_ns();
+    int n = snprintf(buf, sz, "{\n  \"unit\": \"ms\",\n  \"channels\": [\n");
+    for (int ch = 0; ch < nch && n > 0 && (size_t)n < sz; ++ch) {
+        wd_channel_t *c = &g_ch[ch];
+        n += snprintf(buf + n, sz - (size_t)n,
+                      "    {\"name\":\"%s\",\"deadline\":%d,\"age\":%.1f,\"fault\":%s,\"faults\":%llu}%s\n",
+                      c->name, c->deadline_ms,
+                      (double)(now - atomic_load_explicit(&c->last_kick_ns, memory_order_relaxed)) / 1e6,
+                      atomic_load_explicit(&c->fault, memory_order_relaxed) ? "true" : "false",
+                      (unsigned long long)atomic_load_explicit(&c->faults, memory_order_relaxed),
+                      ch == nch - 1 ? "" : ",");
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "  ],\n  \"postmortems\": [\n");
+    /* Jalons datés relativement à la détection (négatifs) */
+    watchdog_pm_t pm;
+    for (int i = 0; watchdog_postmortem(i, &pm) == 0 && n > 0 && (size_t)n < sz; ++i) {
+        n += snprintf(buf + n, sz - (size_t)n,
+                      "%s    {\"channel\":\"%s\",\"deadline\":%d,\"ago\":%.1f,\"last_kick\":%.1f,\"trace\":[",
+                      i ? ",\n" : "", pm.channel, pm.deadline_ms, (double)(now - pm.detected_ns) / 1e6,
+                      (double)(pm.last_kick_ns - pm.detected_ns) / 1e6);
+        for (int k = 0; k < pm.n && n > 0 && (size_t)n < sz; ++k) {
+            n += snprintf(buf + n, sz - (size_t)n, "%s{\"stage\":\"%s\",\"t\":%.3f}", k ? "," : "",
+                          pm.trace[k].stage ? pm.trace[k].stage : "?",
+                          (double)(pm.trace[k].ts_ns - pm.detected_ns) / 1e6);
+        }
+        if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "]}");
+    }
+    if (n > 0 && (size_t)n < sz) n += snprintf(buf + n, sz - (size_t)n, "\n  ]\n}\n");
+    return n;
+}
+
+/* -------------------- Canal 0 (API historique) -------------------- */
+
 void watchdog_kick(void) {
-    clock_gettime(CLOCK_MONOTONIC, &g_last_kick);
+    watchdog_kick_ch(WATCHDOG_CH_PROT);
     // On ne log pas ici pour éviter le bruit. En cas de debug, on peut ajouter un trace.
 }
 
 int watchdog_check(void) {
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    int64_t elapsed = ts_diff_ms(&now, &g_last_kick);
-    if (elapsed > g_timeout_ms) {
-        if (!g_fault) {
-            // Première détection de faute
-            g_fault = 1;
-        }
-        return 1; // FAULT
-    }
-    g_fault = 0;
-    return 0; // OK
+    watchdog_check_all();
+    return watchdog_is_fault();
 }
 
 int watchdog_is_fault(void) {
-    return g_fault;
+    wd_channel_t *c = channel(WATCHDOG_CH_PROT);
+    return c ? atomic_load_explicit(&c->fault, memory_order_relaxed) : 0;
 }
 
 int watchdog_get_timeout_ms(void) {
-    return g_timeout_ms;
+    wd_channel_t *c = channel(WATCHDOG_CH_PROT);
+    return c ? c->deadline_ms : WATCHDOG_TIMEOUT_MS_DEFAULT;
 }
@@ -1,24 +1,75 @@
-
 // src/watchdog.h
 #pragma once
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/*
+ * Watchdog à canaux nommés, chacun avec son échéance. Un canal est "kické"
+ * par le thread qu'il surveille (horodatage atomique, sans verrou, tout
+ * thread) et jalonné par watchdog_mark() (anneau des WATCHDOG_TRACE_LEN
+ * derniers étages, un écrivain par canal). watchdog_check_all() (thread NRT)
+ * détecte les canaux en retard: à l'expiration, les jalons du canal sont
+ * figés dans un post-mortem préalloué (WATCHDOG_PM_SLOTS derniers),
+ * consultable par watchdog_build_json (GET /watchdog).
+ *
+ * Le canal 0 (WATCHDOG_CH_PROT, "protection") est créé par watchdog_init:
+ * watchdog_kick / watchdog_check / watchdog_is_fault s'y appliquent.
+ */
+
 // Timeout par défaut (ms) si rien n'est précisé lors de l'init
 #define WATCHDOG_TIMEOUT_MS_DEFAULT 1500
 
-// Initialise le watchdog avec un timeout (ms).
+#define WATCHDOG_MAX_CHANNELS 8
+#define WATCHDOG_TRACE_LEN    16   // jalons conservés par canal
+#define WATCHDOG_PM_SLOTS     4    // post-mortems conservés
+#define WATCHDOG_CH_PROT      0    // canal de task_protection
+
+typedef struct {
+    const char *stage;    // nom de l'étage (chaîne statique)
+    int64_t     ts_ns;    // CLOCK_MONOTONIC
+} watchdog_mark_t;
+
+typedef struct {
+    char     channel[16];
+    int      deadline_ms;
+    int64_t  detected_ns;              // détection du retard
+    int64_t  last_kick_ns;             // dernier kick avant l'expiration
+    int      n;                        // jalons valides
+    watchdog_mark_t trace[WATCHDOG_TRACE_LEN]; // du plus ancien au plus récent
+} watchdog_pm_t;
+
+// Initialise le watchdog (canaux effacés) et crée le canal 0 avec un timeout (ms).
 // Retourne 0 si OK, -1 si argument invalide.
 int watchdog_init(int timeout_ms);
 
+// Ajoute un canal (avant le démarrage des threads). Retourne son numéro, -1 si plein.
+int watchdog_add_channel(const char *name, int deadline_ms);
+
+// Heartbeat du canal ch (tout thread, sans verrou).
+void watchdog_kick_ch(int ch);
+
+// Jalon du canal ch: stage = chaîne statique. Un seul thread écrivain par canal.
+void watchdog_mark(int ch, const char *stage);
+
+// Vérifie tous les canaux, fige un post-mortem par nouvelle expiration.
+// Retourne le nombre de nouvelles expirations.
+int watchdog_check_all(void);
+
+// Post-mortem i (0 = le plus récent). Retourne 0 si OK, -1 si absent.
+int watchdog_postmortem(int i, watchdog_pm_t *out);
+
+// JSON des canaux et des post-mortems (ms). Retourne la longueur écrite.
+int watchdog_build_json(char *buf, size_t sz);
+
 // "Kick" (heartbeat) à appeler depuis task_protection quand le cycle s'est bien déroulé.
 void watchdog_kick(void);
 
-// Vérifie si le délai depuis le dernier kick dépasse le timeout.
-// Retourne 1 si FAULT détecté, 0 sinon.
+// Vérifie si le délai depuis le dernier kick dépasse le timeout (canal 0; tous
+// les canaux sont vérifiés). Retourne 1 si FAULT détecté, 0 sinon.
 int watchdog_check(void);
 
 // Indique si le watchdog est actuellement en faute (dernière vérif).